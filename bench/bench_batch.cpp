@@ -0,0 +1,161 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Dmitrii Lebed <lebed.dmitry@gmail.com>
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+/*
+ * Batch field extraction from a descriptor ring (strided word loads): every
+ * BitFieldSetBatch kernel against a plain loop of per-set get()/set()
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include <bitfieldset_batch.hpp>
+
+using namespace hal;
+
+/* 16-byte descriptor, extracted field is located in the second word */
+template <typename TWord>
+struct BenchRingDescDef {
+	static constexpr size_t bits = std::numeric_limits<TWord>::digits;
+
+	enum FIELDS {
+		ADDR,
+		LEN,
+		STATUS,
+		CTRL,
+
+		/* keep last */
+		FIELD_COUNT
+	};
+
+	using WordType = TWord;
+
+	static constexpr size_t fieldCount = FIELD_COUNT;
+	static constexpr size_t wordCount = 16 / sizeof(TWord);
+
+	__extension__
+	static constexpr struct BitField<WordType> layout[fieldCount] =
+	{
+		[ADDR]		= { .word = 0,	.lsb = 0,			.msb = bits - 1		},
+		[LEN]		= { .word = 1,	.lsb = 0,			.msb = bits / 2 - 1	},
+		[STATUS]	= { .word = 1,	.lsb = bits / 2,	.msb = bits / 2 + 7	},
+		[CTRL]		= { .word = wordCount - 1,	.lsb = bits - 8,	.msb = bits - 1	},
+	};
+};
+
+static constexpr size_t ringSize = 1024;
+
+template <typename TWord>
+static std::vector<BitFieldSet<BenchRingDescDef<TWord>>> makeRing()
+{
+	using Desc = BitFieldSet<BenchRingDescDef<TWord>>;
+	std::vector<Desc> ring(ringSize);
+
+	for (size_t i = 0; i < ringSize; i++) {
+		ring[i].resetAll();
+		ring[i].template set<Desc::LEN, Desc::STATUS>(static_cast<TWord>(i), static_cast<TWord>(i & 0xff));
+	}
+
+	return ring;
+}
+
+template <typename TWord>
+static void BM_GetLoop(benchmark::State &state)
+{
+	using Desc = BitFieldSet<BenchRingDescDef<TWord>>;
+	auto ring = makeRing<TWord>();
+	std::vector<TWord> out(ringSize);
+
+	for (auto _ : state) {
+		for (size_t i = 0; i < ringSize; i++) {
+			out[i] = ring[i].template get<Desc::STATUS>();
+		}
+
+		benchmark::DoNotOptimize(out.data());
+		benchmark::ClobberMemory();
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * ringSize));
+}
+
+template <typename TWord, BitFieldBatchKernel kernel>
+static void BM_BatchGet(benchmark::State &state)
+{
+	using Desc = BitFieldSet<BenchRingDescDef<TWord>>;
+	using Batch = BitFieldSetBatch<Desc>;
+	auto ring = makeRing<TWord>();
+	std::vector<TWord> out(ringSize);
+
+	if (!Batch::supported(kernel)) {
+		state.SkipWithError("kernel is not supported");
+		return;
+	}
+
+	for (auto _ : state) {
+		Batch::template get<Desc::STATUS, kernel>(ring.data(), ringSize, out.data());
+		benchmark::DoNotOptimize(out.data());
+		benchmark::ClobberMemory();
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * ringSize));
+}
+
+template <typename TWord>
+static void BM_SetLoop(benchmark::State &state)
+{
+	using Desc = BitFieldSet<BenchRingDescDef<TWord>>;
+	auto ring = makeRing<TWord>();
+	std::vector<TWord> values(ringSize, 0x5a);
+
+	for (auto _ : state) {
+		for (size_t i = 0; i < ringSize; i++) {
+			ring[i].template set<Desc::STATUS>(values[i]);
+		}
+
+		benchmark::DoNotOptimize(ring.data());
+		benchmark::ClobberMemory();
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * ringSize));
+}
+
+template <typename TWord, BitFieldBatchKernel kernel>
+static void BM_BatchSet(benchmark::State &state)
+{
+	using Desc = BitFieldSet<BenchRingDescDef<TWord>>;
+	using Batch = BitFieldSetBatch<Desc>;
+	auto ring = makeRing<TWord>();
+	std::vector<TWord> values(ringSize, 0x5a);
+
+	if (!Batch::supported(kernel)) {
+		state.SkipWithError("kernel is not supported");
+		return;
+	}
+
+	for (auto _ : state) {
+		Batch::template set<Desc::STATUS, kernel>(ring.data(), ringSize, values.data());
+		benchmark::DoNotOptimize(ring.data());
+		benchmark::ClobberMemory();
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * ringSize));
+}
+
+BENCHMARK(BM_GetLoop<uint32_t>);
+BENCHMARK(BM_BatchGet<uint32_t, BitFieldBatchKernel::SCALAR>);
+BENCHMARK(BM_BatchGet<uint32_t, BitFieldBatchKernel::AVX2>);
+BENCHMARK(BM_BatchGet<uint32_t, BitFieldBatchKernel::AVX512>);
+BENCHMARK(BM_GetLoop<uint64_t>);
+BENCHMARK(BM_BatchGet<uint64_t, BitFieldBatchKernel::SCALAR>);
+BENCHMARK(BM_BatchGet<uint64_t, BitFieldBatchKernel::AVX2>);
+BENCHMARK(BM_BatchGet<uint64_t, BitFieldBatchKernel::AVX512>);
+
+BENCHMARK(BM_SetLoop<uint32_t>);
+BENCHMARK(BM_BatchSet<uint32_t, BitFieldBatchKernel::SCALAR>);
+BENCHMARK(BM_BatchSet<uint32_t, BitFieldBatchKernel::AVX512>);
+BENCHMARK(BM_SetLoop<uint64_t>);
+BENCHMARK(BM_BatchSet<uint64_t, BitFieldBatchKernel::SCALAR>);
+BENCHMARK(BM_BatchSet<uint64_t, BitFieldBatchKernel::AVX512>);
@@ -0,0 +1,220 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Dmitrii Lebed <lebed.dmitry@gmail.com>
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <bitfieldset.hpp>
+
+using namespace hal;
+
+template <typename TWord>
+struct BenchBitFieldDef {
+	static constexpr size_t bits = std::numeric_limits<TWord>::digits;
+
+	enum FIELDS {
+		F1,
+		F2,
+		F3,
+		F4,
+
+		/* keep last */
+		FIELD_COUNT
+	};
+
+	using WordType = TWord;
+
+	static constexpr size_t fieldCount = FIELD_COUNT;
+	static constexpr size_t wordCount = 1;
+
+	__extension__
+	static constexpr struct BitField<WordType> layout[fieldCount] =
+	{
+		[F1]	= { .word = 0,	.lsb = 0,				.msb = 1			},
+		[F2]	= { .word = 0,	.lsb = 2,				.msb = 2			},
+		[F3]	= { .word = 0,	.lsb = 3,				.msb = bits / 2		},
+		[F4]	= { .word = 0,	.lsb = bits / 2 + 1,	.msb = bits - 1		},
+	};
+};
+
+/*
+ * Accessor adapters, every adapter sets two fields, reads two fields
+ * and reads all fields of the word (chained access)
+ */
+
+template <typename TWord, typename TStorage = BitFieldStorage<BenchBitFieldDef<TWord>>>
+struct BitFieldSetAccess {
+	using Def = BenchBitFieldDef<TWord>;
+	using Set = BitFieldSet<Def, TStorage>;
+
+	void set(TWord value)
+	{
+		s.template set<Def::F1>(value);
+		s.template set<Def::F3>(value);
+	}
+
+	TWord get() const
+	{
+		return static_cast<TWord>(s.template get<Def::F1>() + s.template get<Def::F3>());
+	}
+
+	TWord getWord() const
+	{
+		const auto w = s.template word<Def::F1>();
+
+		return static_cast<TWord>(w.template get<Def::F1>() + w.template get<Def::F2>() +
+								  w.template get<Def::F3>() + w.template get<Def::F4>());
+	}
+
+	Set s;
+};
+
+template <typename TWord>
+struct BitFieldSetVolatileAccess : BitFieldSetAccess<TWord> {
+	using Def = BenchBitFieldDef<TWord>;
+
+	void set(TWord value)
+	{
+		vs().template set<Def::F1>(value);
+		vs().template set<Def::F3>(value);
+	}
+
+	TWord get() const
+	{
+		return static_cast<TWord>(vs().template get<Def::F1>() + vs().template get<Def::F3>());
+	}
+
+	TWord getWord() const
+	{
+		const auto w = vs().template word<Def::F1>();
+
+		return static_cast<TWord>(w.template get<Def::F1>() + w.template get<Def::F2>() +
+								  w.template get<Def::F3>() + w.template get<Def::F4>());
+	}
+
+	volatile typename BitFieldSetAccess<TWord>::Set &vs() { return this->s; }
+	const volatile typename BitFieldSetAccess<TWord>::Set &vs() const { return this->s; }
+};
+
+template <typename TWord>
+using BitFieldSetAtomicAccess = BitFieldSetAccess<TWord, BitFieldStorageAtomic<BenchBitFieldDef<TWord>>>;
+
+template <typename TWord, typename TRaw = TWord>
+struct HandMaskAccess {
+	static constexpr size_t bits = std::numeric_limits<TWord>::digits;
+	static constexpr TWord mask1 = 0x3;
+	static constexpr TWord mask2 = 0x4;
+	static constexpr TWord mask3 = static_cast<TWord>(((TWord(1) << (bits / 2 + 1)) - 1) & ~TWord(0x7));
+	static constexpr TWord mask4 = static_cast<TWord>(~(mask1 | mask2 | mask3));
+
+	void set(TWord value)
+	{
+		raw = static_cast<TWord>((raw & ~mask1) | (value & mask1));
+		raw = static_cast<TWord>((raw & ~mask3) | ((value << 3) & mask3));
+	}
+
+	TWord get() const
+	{
+		return static_cast<TWord>((raw & mask1) + ((raw & mask3) >> 3));
+	}
+
+	TWord getWord() const
+	{
+		const TWord w = raw;
+
+		return static_cast<TWord>((w & mask1) + ((w & mask2) >> 2) + ((w & mask3) >> 3) +
+								  ((w & mask4) >> (bits / 2 + 1)));
+	}
+
+	TRaw raw;
+};
+
+template <typename TWord>
+using HandMaskVolatileAccess = HandMaskAccess<TWord, volatile TWord>;
+
+template <typename TWord>
+struct NativeBitFieldAccess {
+	static constexpr size_t bits = std::numeric_limits<TWord>::digits;
+
+	void set(TWord value)
+	{
+		raw.f1 = value & 0x3;
+		raw.f3 = value & ((TWord(1) << (bits / 2 - 2)) - 1);
+	}
+
+	TWord get() const
+	{
+		return static_cast<TWord>(raw.f1 + raw.f3);
+	}
+
+	TWord getWord() const
+	{
+		return static_cast<TWord>(raw.f1 + raw.f2 + raw.f3 + raw.f4);
+	}
+
+	struct {
+		TWord f1 : 2;
+		TWord f2 : 1;
+		TWord f3 : bits / 2 - 2;
+		TWord f4 : bits / 2 - 1;
+	} raw;
+};
+
+template <typename TAccess>
+static void BM_Set(benchmark::State &state)
+{
+	TAccess acc = {};
+	unsigned value = 0;
+
+	for (auto _ : state) {
+		acc.set(static_cast<decltype(acc.get())>(value++));
+		benchmark::ClobberMemory();
+	}
+
+	benchmark::DoNotOptimize(acc.get());
+}
+
+template <typename TAccess>
+static void BM_Get(benchmark::State &state)
+{
+	TAccess acc = {};
+
+	acc.set(5);
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(acc.get());
+		benchmark::ClobberMemory();
+	}
+}
+
+template <typename TAccess>
+static void BM_GetWord(benchmark::State &state)
+{
+	TAccess acc = {};
+
+	acc.set(5);
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(acc.getWord());
+		benchmark::ClobberMemory();
+	}
+}
+
+#define BENCH_ACCESS(access, type)							\
+	BENCHMARK_TEMPLATE(BM_Set, access<type>);				\
+	BENCHMARK_TEMPLATE(BM_Get, access<type>);				\
+	BENCHMARK_TEMPLATE(BM_GetWord, access<type>)
+
+#define BENCH_WORD_TYPE(type)								\
+	BENCH_ACCESS(BitFieldSetAccess, type);					\
+	BENCH_ACCESS(BitFieldSetVolatileAccess, type);			\
+	BENCH_ACCESS(BitFieldSetAtomicAccess, type);			\
+	BENCH_ACCESS(HandMaskAccess, type);						\
+	BENCH_ACCESS(HandMaskVolatileAccess, type);				\
+	BENCH_ACCESS(NativeBitFieldAccess, type)
+
+BENCH_WORD_TYPE(uint8_t);
+BENCH_WORD_TYPE(uint16_t);
+BENCH_WORD_TYPE(uint32_t);
+BENCH_WORD_TYPE(uint64_t);
@@ -0,0 +1,149 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Dmitrii Lebed <lebed.dmitry@gmail.com>
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+/*
+ * Whole range CSR access on host CSR emulation backend (CONFIG_RV_CSR_HOST):
+ * per-index dispatch through jump table and function table against unrolled
+ * csr_read_range()/csr_write_range().
+ * CSR_INDEXED_ASM jump table is RISC-V only, on the host it is modelled with
+ * a dense switch the compiler lowers to a jump table. Absolute numbers include
+ * host emulation cost of every CSR access, only the difference is meaningful
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <arch/riscv/rv_csr.hpp>
+
+using namespace rv;
+
+/* dense switch over [start, end], lowered to a jump table */
+template <csr start, csr end>
+static uxlen_t jump_table_read(size_t idx)
+{
+	constexpr size_t start_idx = static_cast<size_t>(start);
+	constexpr size_t csr_count = static_cast<size_t>(end) - start_idx + 1;
+	uxlen_t res = 0;
+
+	[&]<size_t... I>(std::index_sequence<I...>) {
+		static_cast<void>(((idx == I ? (res = csr_read<static_cast<csr>(start_idx + I)>(), true) : false) || ...));
+	}(std::make_index_sequence<csr_count>{});
+
+	return res;
+}
+
+template <csr start, csr end>
+static void jump_table_write(size_t idx, uxlen_t value)
+{
+	constexpr size_t start_idx = static_cast<size_t>(start);
+	constexpr size_t csr_count = static_cast<size_t>(end) - start_idx + 1;
+
+	[&]<size_t... I>(std::index_sequence<I...>) {
+		static_cast<void>(((idx == I ? (csr_write<static_cast<csr>(start_idx + I)>(value), true) : false) || ...));
+	}(std::make_index_sequence<csr_count>{});
+}
+
+template <csr start, csr end>
+static constexpr size_t range_count = static_cast<size_t>(end) - static_cast<size_t>(start) + 1;
+
+template <csr start, csr end>
+static void BM_ReadJumpTable(benchmark::State &state)
+{
+	std::array<uxlen_t, range_count<start, end>> out;
+
+	for (auto _ : state) {
+		for (size_t i = 0; i < out.size(); i++) {
+			size_t idx = i;
+
+			benchmark::DoNotOptimize(idx);
+			out[i] = jump_table_read<start, end>(idx);
+		}
+
+		benchmark::DoNotOptimize(out);
+	}
+}
+
+template <csr start, csr end>
+static void BM_ReadFuncTable(benchmark::State &state)
+{
+	std::array<uxlen_t, range_count<start, end>> out;
+
+	for (auto _ : state) {
+		for (size_t i = 0; i < out.size(); i++) {
+			size_t idx = i;
+
+			benchmark::DoNotOptimize(idx);
+			out[i] = helpers::csr_read_indexed<start, end>(idx);
+		}
+
+		benchmark::DoNotOptimize(out);
+	}
+}
+
+template <csr start, csr end>
+static void BM_ReadRange(benchmark::State &state)
+{
+	std::array<uxlen_t, range_count<start, end>> out;
+
+	for (auto _ : state) {
+		csr_read_range<start, end>(out);
+		benchmark::DoNotOptimize(out);
+	}
+}
+
+template <csr start, csr end>
+static void BM_WriteJumpTable(benchmark::State &state)
+{
+	std::array<uxlen_t, range_count<start, end>> in = {};
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(in);
+
+		for (size_t i = 0; i < in.size(); i++) {
+			size_t idx = i;
+
+			benchmark::DoNotOptimize(idx);
+			jump_table_write<start, end>(idx, in[i]);
+		}
+	}
+}
+
+template <csr start, csr end>
+static void BM_WriteFuncTable(benchmark::State &state)
+{
+	std::array<uxlen_t, range_count<start, end>> in = {};
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(in);
+
+		for (size_t i = 0; i < in.size(); i++) {
+			size_t idx = i;
+
+			benchmark::DoNotOptimize(idx);
+			helpers::csr_write_indexed<start, end>(idx, in[i]);
+		}
+	}
+}
+
+template <csr start, csr end>
+static void BM_WriteRange(benchmark::State &state)
+{
+	std::array<uxlen_t, range_count<start, end>> in = {};
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(in);
+		csr_write_range<start, end>(in);
+	}
+}
+
+BENCHMARK(BM_ReadJumpTable<csr::pmpaddr0, csr::pmpaddr15>);
+BENCHMARK(BM_ReadFuncTable<csr::pmpaddr0, csr::pmpaddr15>);
+BENCHMARK(BM_ReadRange<csr::pmpaddr0, csr::pmpaddr15>);
+BENCHMARK(BM_WriteJumpTable<csr::pmpaddr0, csr::pmpaddr15>);
+BENCHMARK(BM_WriteFuncTable<csr::pmpaddr0, csr::pmpaddr15>);
+BENCHMARK(BM_WriteRange<csr::pmpaddr0, csr::pmpaddr15>);
+
+BENCHMARK(BM_ReadJumpTable<csr::mhpmcounter3, csr::mhpmcounter31>);
+BENCHMARK(BM_ReadFuncTable<csr::mhpmcounter3, csr::mhpmcounter31>);
+BENCHMARK(BM_ReadRange<csr::mhpmcounter3, csr::mhpmcounter31>);
@@ -0,0 +1,145 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Dmitrii Lebed <lebed.dmitry@gmail.com>
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+/*
+ * Multi-field unpack()/pack() against per-field get() and multi-field set(), built with
+ * CONFIG_BITFIELDSET_BMI2 on x86-64 to compare pext/pdep path with the scalar one.
+ * Every descriptor is consumed separately (as in completion parsing) to prevent the
+ * compiler from vectorizing the scalar path across descriptors
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <bitfieldset.hpp>
+
+using namespace hal;
+
+/* completion descriptor, 8 fields of different width */
+struct BenchCompletionDef {
+	enum FIELDS {
+		STATUS,
+		ERR,
+		QID,
+		PHASE,
+		TAG,
+		LEN,
+		FLAGS,
+		CRC_OK,
+
+		/* keep last */
+		FIELD_COUNT
+	};
+
+	using WordType = uint32_t;
+
+	static constexpr size_t fieldCount = FIELD_COUNT;
+	static constexpr size_t wordCount = 2;
+
+	__extension__
+	static constexpr struct BitField<WordType> layout[fieldCount] =
+	{
+		[STATUS]	= { .word = 0,	.lsb = 0,	.msb = 3	},
+		[ERR]		= { .word = 0,	.lsb = 5,	.msb = 7	},
+		[QID]		= { .word = 0,	.lsb = 8,	.msb = 17	},
+		[PHASE]		= { .word = 0,	.lsb = 19,	.msb = 19	},
+		[TAG]		= { .word = 0,	.lsb = 20,	.msb = 31	},
+		[LEN]		= { .word = 1,	.lsb = 0,	.msb = 15	},
+		[FLAGS]		= { .word = 1,	.lsb = 17,	.msb = 23	},
+		[CRC_OK]	= { .word = 1,	.lsb = 31,	.msb = 31	},
+	};
+};
+
+using Cpl = BitFieldSet<BenchCompletionDef>;
+using CplDef = BenchCompletionDef;
+
+static constexpr size_t cplCount = 256;
+
+static void fillCompletions(Cpl *cpls)
+{
+	for (size_t i = 0; i < cplCount; i++) {
+		const uint32_t v = static_cast<uint32_t>(i * 0x9e3779b9u);
+
+		cpls[i].set<CplDef::STATUS, CplDef::ERR, CplDef::QID, CplDef::PHASE,
+					CplDef::TAG, CplDef::LEN, CplDef::FLAGS, CplDef::CRC_OK>(
+			v, v >> 4, v >> 7, v >> 9, v >> 11, v >> 13, v >> 17, v >> 19);
+	}
+}
+
+static void BM_UnpackScalar(benchmark::State &state)
+{
+	Cpl cpls[cplCount];
+
+	fillCompletions(cpls);
+
+	for (auto _ : state) {
+		for (const auto &c : cpls) {
+			benchmark::DoNotOptimize(c.get<CplDef::STATUS>() + c.get<CplDef::ERR>() +
+									 c.get<CplDef::QID>() + c.get<CplDef::PHASE>() +
+									 c.get<CplDef::TAG>() + c.get<CplDef::LEN>() +
+									 c.get<CplDef::FLAGS>() + c.get<CplDef::CRC_OK>());
+		}
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * cplCount));
+}
+
+static void BM_Unpack(benchmark::State &state)
+{
+	Cpl cpls[cplCount];
+
+	fillCompletions(cpls);
+
+	for (auto _ : state) {
+		for (const auto &c : cpls) {
+			const auto v = c.unpack<CplDef::STATUS, CplDef::ERR, CplDef::QID, CplDef::PHASE,
+									CplDef::TAG, CplDef::LEN, CplDef::FLAGS, CplDef::CRC_OK>();
+
+			benchmark::DoNotOptimize(v[0] + v[1] + v[2] + v[3] + v[4] + v[5] + v[6] + v[7]);
+		}
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * cplCount));
+}
+
+static void BM_PackScalar(benchmark::State &state)
+{
+	Cpl cpls[cplCount];
+	uint32_t v = 0;
+
+	for (auto _ : state) {
+		for (auto &c : cpls) {
+			c.set<CplDef::STATUS, CplDef::ERR, CplDef::QID, CplDef::PHASE,
+				  CplDef::TAG, CplDef::LEN, CplDef::FLAGS, CplDef::CRC_OK>(
+				v, v + 1, v + 2, v + 3, v + 4, v + 5, v + 6, v + 7);
+			v++;
+			benchmark::ClobberMemory();
+		}
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * cplCount));
+}
+
+static void BM_Pack(benchmark::State &state)
+{
+	Cpl cpls[cplCount];
+	uint32_t v = 0;
+
+	for (auto _ : state) {
+		for (auto &c : cpls) {
+			c.pack<CplDef::STATUS, CplDef::ERR, CplDef::QID, CplDef::PHASE,
+				   CplDef::TAG, CplDef::LEN, CplDef::FLAGS, CplDef::CRC_OK>(
+				{ v, v + 1, v + 2, v + 3, v + 4, v + 5, v + 6, v + 7 });
+			v++;
+			benchmark::ClobberMemory();
+		}
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * cplCount));
+}
+
+BENCHMARK(BM_UnpackScalar);
+BENCHMARK(BM_Unpack);
+BENCHMARK(BM_PackScalar);
+BENCHMARK(BM_Pack);
@@ -0,0 +1,19 @@
+# To add benchmark target use
+#	bench_add_bench(my_bench_target bench1.cpp bench2.cpp)
+macro(bench_add_bench bench_name)
+	set(BenchFiles ${ARGN})
+
+	add_executable(${bench_name} ${BenchFiles})
+
+	target_link_libraries(${bench_name} benchmark::benchmark_main)
+
+	list(APPEND BENCH_TARGETS ${bench_name})
+
+	get_directory_property(hasParent PARENT_DIRECTORY)
+
+	if(hasParent)
+		set(BENCH_TARGETS ${BENCH_TARGETS} PARENT_SCOPE)
+	else()
+		set(BENCH_TARGETS ${BENCH_TARGETS})
+	endif()
+endmacro()
@@ -0,0 +1,107 @@
+# Generated code checker, run as a script:
+#	cmake -DOBJDUMP=<objdump> -DOBJECT=<object file> -DSOURCE=<source file> -P codegen.cmake
+#
+# Source file declares per-function upper bounds in comments:
+#	/* codegen: <function> insns=<N> loads=<N> stores=<N> */
+# Object file is disassembled (x86-64, Intel syntax) and every declared function is checked
+# against its bounds. Memory accesses are counted by instruction operands, stack accesses
+# done by push/pop/call/ret are not counted.
+
+foreach(var OBJDUMP OBJECT SOURCE)
+	if(NOT DEFINED ${var})
+		message(FATAL_ERROR "${var} is not defined")
+	endif()
+endforeach()
+
+execute_process(
+	COMMAND ${OBJDUMP} -d --no-show-raw-insn -M intel ${OBJECT}
+	OUTPUT_VARIABLE disasm
+	RESULT_VARIABLE res
+)
+
+if(NOT res EQUAL 0)
+	message(FATAL_ERROR "Failed to disassemble ${OBJECT}")
+endif()
+
+# Split disassembly into per-function instruction lists
+string(REPLACE ";" "\\;" disasm "${disasm}")
+string(REPLACE "\n" ";" disasm_lines "${disasm}")
+
+set(func "")
+
+foreach(line IN LISTS disasm_lines)
+	if(line MATCHES "^[0-9a-f]+ <([A-Za-z0-9_]+)>:$")
+		set(func ${CMAKE_MATCH_1})
+		set(insns_${func} "")
+	elseif(func AND line MATCHES "^ +[0-9a-f]+:\t(.+)$")
+		string(STRIP "${CMAKE_MATCH_1}" insn)
+
+		if(NOT insn MATCHES "^(nop|xchg +ax,ax|data16|cs nop)")
+			list(APPEND insns_${func} "${insn}")
+		endif()
+	endif()
+endforeach()
+
+file(STRINGS ${SOURCE} checks REGEX "codegen: [A-Za-z0-9_]+ ")
+
+set(failed FALSE)
+
+foreach(check IN LISTS checks)
+	if(NOT check MATCHES "codegen: ([A-Za-z0-9_]+) insns=([0-9]+) loads=([0-9]+) stores=([0-9]+)")
+		message(FATAL_ERROR "Malformed check: ${check}")
+	endif()
+
+	set(name ${CMAKE_MATCH_1})
+	set(max_insns ${CMAKE_MATCH_2})
+	set(max_loads ${CMAKE_MATCH_3})
+	set(max_stores ${CMAKE_MATCH_4})
+
+	if(NOT DEFINED insns_${name})
+		message(SEND_ERROR "${name}: function is not found in ${OBJECT}")
+		set(failed TRUE)
+		continue()
+	endif()
+
+	set(insns 0)
+	set(loads 0)
+	set(stores 0)
+
+	foreach(insn IN LISTS insns_${name})
+		math(EXPR insns "${insns} + 1")
+
+		if(NOT insn MATCHES "\\[" OR insn MATCHES "^(lea|nop)")
+			continue()
+		endif()
+
+		# "mnemonic dst,src", memory destination is written (and read for RMW instructions)
+		string(REGEX REPLACE "^(lock +)?([a-z0-9]+) +([^,]*)(,.*)?$" "\\2" mnemonic "${insn}")
+		string(REGEX REPLACE "^(lock +)?([a-z0-9]+) +([^,]*)(,.*)?$" "\\3" dst "${insn}")
+
+		if(dst MATCHES "\\[")
+			if(mnemonic MATCHES "^(cmp|test|bt|ucomis|comis)")
+				math(EXPR loads "${loads} + 1")
+			elseif(mnemonic MATCHES "^(mov|set|st)")
+				math(EXPR stores "${stores} + 1")
+			else()
+				math(EXPR loads "${loads} + 1")
+				math(EXPR stores "${stores} + 1")
+			endif()
+		else()
+			math(EXPR loads "${loads} + 1")
+		endif()
+	endforeach()
+
+	set(result "${name}: insns=${insns}/${max_insns} loads=${loads}/${max_loads} stores=${stores}/${max_stores}")
+
+	if(insns GREATER max_insns OR loads GREATER max_loads OR stores GREATER max_stores)
+		string(REPLACE ";" "\n\t" listing "${insns_${name}}")
+		message(SEND_ERROR "${result} - bounds exceeded:\n\t${listing}")
+		set(failed TRUE)
+	else()
+		message(STATUS "${result}")
+	endif()
+endforeach()
+
+if(failed)
+	message(FATAL_ERROR "Generated code check failed")
+endif()
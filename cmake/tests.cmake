@@ -20,6 +20,44 @@ macro(tests_add_test test_name)
 	endif()
 endmacro()
 
+# To add generated code check target use
+#	tests_add_codegen_test(my_check_target source.cpp)
+# Source file is compiled with -O2 (no sanitizers) and checked by codegen.cmake script.
+# Only the configured compiler is built and bounds in the source are measured with gcc
+# (12, x86-64), so check is added for gcc x86-64 builds only, clang is not checked
+macro(tests_add_codegen_test test_name source)
+	if(NOT CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+		message(STATUS "${test_name}: codegen bounds are given for gcc only, check is skipped")
+	elseif(CMAKE_SYSTEM_PROCESSOR MATCHES "x86_64|AMD64" AND CMAKE_OBJDUMP)
+		add_library(${test_name} OBJECT ${source})
+
+		target_compile_options(${test_name} PRIVATE
+			-O2
+			-fno-sanitize=all
+			-fno-stack-protector
+			-fcf-protection=none
+		)
+
+		add_test(NAME ${test_name}
+			COMMAND ${CMAKE_COMMAND}
+				-DOBJDUMP=${CMAKE_OBJDUMP}
+				-DOBJECT=$<TARGET_OBJECTS:${test_name}>
+				-DSOURCE=${CMAKE_CURRENT_SOURCE_DIR}/${source}
+				-P ${PROJ_DIR}/cmake/codegen.cmake
+		)
+
+		list(APPEND TEST_TARGETS ${test_name})
+
+		get_directory_property(hasParent PARENT_DIRECTORY)
+
+		if(hasParent)
+			set(TEST_TARGETS ${TEST_TARGETS} PARENT_SCOPE)
+		else()
+			set(TEST_TARGETS ${TEST_TARGETS})
+		endif()
+	endif()
+endmacro()
+
 # Enable sanitizers
 if (${CMAKE_SYSTEM_NAME} MATCHES "Linux")
 	add_compile_options(-fsanitize=leak -fsanitize=undefined -fsanitize=address)
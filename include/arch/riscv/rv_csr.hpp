@@ -10,8 +10,13 @@
 #include <cstddef>
 #include <utility>
 #include <array>
+#include <span>
 #include "rv_types.hpp"
 
+#ifdef CONFIG_RV_CSR_HOST
+#include "rv_csr_host.hpp"
+#endif
+
 namespace rv {
 
 enum class csr : uint16_t {
@@ -85,6 +90,24 @@ enum class csr : uint16_t {
 	bstval                          = 0x243,
 	bsip                            = 0x244,
 	bsatp                           = 0x280,
+	/* Virtual supervisor status (ratified name of bsstatus) */
+	vsstatus                        = 0x200,
+	/* Virtual supervisor interrupt enable */
+	vsie                            = 0x204,
+	/* Virtual supervisor trap handler base address */
+	vstvec                          = 0x205,
+	/* Virtual supervisor scratch register */
+	vsscratch                       = 0x240,
+	/* Virtual supervisor exception program counter */
+	vsepc                           = 0x241,
+	/* Virtual supervisor trap cause */
+	vscause                         = 0x242,
+	/* Virtual supervisor bad address or instruction */
+	vstval                          = 0x243,
+	/* Virtual supervisor interrupt pending */
+	vsip                            = 0x244,
+	/* Virtual supervisor address translation and protection */
+	vsatp                           = 0x280,
 	/* Machine Status */
 	mstatus                         = 0x300,
 	/* Machine ISA */
@@ -422,6 +445,76 @@ enum class csr : uint16_t {
 	mconfigptr                      = 0xf15,
 };
 
+#ifdef CONFIG_RV_CSR_HOST
+
+template <csr reg>
+inline uxlen_t csr_read()
+{
+	return host::hart_csrs.read(reg);
+}
+
+template <csr reg>
+inline void csr_write(uxlen_t value)
+{
+	host::hart_csrs.write(reg, value);
+}
+
+template <csr reg>
+inline uxlen_t csr_swap(uxlen_t value)
+{
+	return host::hart_csrs.swap(reg, value);
+}
+
+template <csr reg>
+inline uxlen_t csr_read_set(uxlen_t mask)
+{
+	return host::hart_csrs.set_bits(reg, mask);
+}
+
+template <csr reg>
+inline uxlen_t csr_read_clear(uxlen_t mask)
+{
+	return host::hart_csrs.clear_bits(reg, mask);
+}
+
+template <csr reg, uxlen_t mask>
+inline uxlen_t csr_read_set()
+{
+	return host::hart_csrs.set_bits(reg, mask);
+}
+
+template <csr reg, uxlen_t mask>
+inline uxlen_t csr_read_clear()
+{
+	return host::hart_csrs.clear_bits(reg, mask);
+}
+
+template <csr reg>
+inline void csr_set(uxlen_t mask)
+{
+	host::hart_csrs.set_bits(reg, mask);
+}
+
+template <csr reg>
+inline void csr_clear(uxlen_t mask)
+{
+	host::hart_csrs.clear_bits(reg, mask);
+}
+
+template <csr reg, uxlen_t mask>
+inline void csr_set()
+{
+	host::hart_csrs.set_bits(reg, mask);
+}
+
+template <csr reg, uxlen_t mask>
+inline void csr_clear()
+{
+	host::hart_csrs.clear_bits(reg, mask);
+}
+
+#else
+
 template <csr reg>
 inline uxlen_t csr_read()
 {
@@ -448,9 +541,156 @@ inline void csr_write(uxlen_t value)
 				:						/* clobbers: none */);
 }
 
+/* csrrw: write #value, return previous CSR value */
+template <csr reg>
+inline uxlen_t csr_swap(uxlen_t value)
+{
+	constexpr size_t idx = static_cast<size_t>(reg);
+	uxlen_t res;
+
+	asm volatile("csrrw %[res], %[idx], %[val]"
+				: [res] "=r" (res)		/* output */
+				: [val] "r" (value),
+				  [idx] "i" (idx)		/* input */
+				:						/* clobbers: none */);
+
+	return res;
+}
+
+/* csrrs: set #mask bits, return previous CSR value */
+template <csr reg>
+inline uxlen_t csr_read_set(uxlen_t mask)
+{
+	constexpr size_t idx = static_cast<size_t>(reg);
+	uxlen_t res;
+
+	asm volatile("csrrs %[res], %[idx], %[mask]"
+				: [res] "=r" (res)		/* output */
+				: [mask] "r" (mask),
+				  [idx] "i" (idx)		/* input */
+				:						/* clobbers: none */);
+
+	return res;
+}
+
+/* csrrc: clear #mask bits, return previous CSR value */
+template <csr reg>
+inline uxlen_t csr_read_clear(uxlen_t mask)
+{
+	constexpr size_t idx = static_cast<size_t>(reg);
+	uxlen_t res;
+
+	asm volatile("csrrc %[res], %[idx], %[mask]"
+				: [res] "=r" (res)		/* output */
+				: [mask] "r" (mask),
+				  [idx] "i" (idx)		/* input */
+				:						/* clobbers: none */);
+
+	return res;
+}
+
+/* Constant mask forms, 5-bit masks use immediate instructions (csrrsi/csrrci) */
+template <csr reg, uxlen_t mask>
+inline uxlen_t csr_read_set()
+{
+	constexpr size_t idx = static_cast<size_t>(reg);
+	uxlen_t res;
+
+	if constexpr (mask < 32) {
+		asm volatile("csrrsi %[res], %[idx], %[mask]"
+					: [res] "=r" (res)		/* output */
+					: [mask] "i" (mask),
+					  [idx] "i" (idx)		/* input */
+					:						/* clobbers: none */);
+	} else {
+		res = csr_read_set<reg>(mask);
+	}
+
+	return res;
+}
+
+template <csr reg, uxlen_t mask>
+inline uxlen_t csr_read_clear()
+{
+	constexpr size_t idx = static_cast<size_t>(reg);
+	uxlen_t res;
+
+	if constexpr (mask < 32) {
+		asm volatile("csrrci %[res], %[idx], %[mask]"
+					: [res] "=r" (res)		/* output */
+					: [mask] "i" (mask),
+					  [idx] "i" (idx)		/* input */
+					:						/* clobbers: none */);
+	} else {
+		res = csr_read_clear<reg>(mask);
+	}
+
+	return res;
+}
+
+/* csrs: set #mask bits */
+template <csr reg>
+inline void csr_set(uxlen_t mask)
+{
+	constexpr size_t idx = static_cast<size_t>(reg);
+
+	asm volatile("csrs %[idx], %[mask]"
+				: 						/* output */
+				: [mask] "r" (mask),
+				  [idx] "i" (idx)		/* input */
+				:						/* clobbers: none */);
+}
+
+/* csrc: clear #mask bits */
+template <csr reg>
+inline void csr_clear(uxlen_t mask)
+{
+	constexpr size_t idx = static_cast<size_t>(reg);
+
+	asm volatile("csrc %[idx], %[mask]"
+				: 						/* output */
+				: [mask] "r" (mask),
+				  [idx] "i" (idx)		/* input */
+				:						/* clobbers: none */);
+}
+
+template <csr reg, uxlen_t mask>
+inline void csr_set()
+{
+	constexpr size_t idx = static_cast<size_t>(reg);
+
+	if constexpr (mask < 32) {
+		asm volatile("csrsi %[idx], %[mask]"
+					: 						/* output */
+					: [mask] "i" (mask),
+					  [idx] "i" (idx)		/* input */
+					:						/* clobbers: none */);
+	} else {
+		csr_set<reg>(mask);
+	}
+}
+
+template <csr reg, uxlen_t mask>
+inline void csr_clear()
+{
+	constexpr size_t idx = static_cast<size_t>(reg);
+
+	if constexpr (mask < 32) {
+		asm volatile("csrci %[idx], %[mask]"
+					: 						/* output */
+					: [mask] "i" (mask),
+					  [idx] "i" (idx)		/* input */
+					:						/* clobbers: none */);
+	} else {
+		csr_clear<reg>(mask);
+	}
+}
+
+#endif
+
 namespace helpers {
 
-#ifdef CONFIG_RV_CSR_INDEXED_ASM
+#if defined(CONFIG_RV_CSR_INDEXED_ASM) && !defined(CONFIG_RV_CSR_HOST)
 
 #define CSR_INDEXED_ASM(STMT) \
 	"lla %[jmp_dst], 1						\n"	\
@@ -504,9 +744,9 @@ void csr_write_indexed(size_t idx, uxlen_t value)
 	static_assert(end_idx >= start_idx, "Invalid range");
 
 	asm volatile(CSR_INDEXED_ASM("csrw (reg_idx), %[val]")
-				: [val] "=r" (value),
-				  [jmp_dst] "=&r" (tmp)					/* output */
-				: [csr_count] "i" (csr_count),
+				: [jmp_dst] "=&r" (tmp)					/* output */
+				: [val] "r" (value),
+				  [csr_count] "i" (csr_count),
 				  [start] "i" (start_idx),
 				  [index] "r" (idx * jump_entry_size)	/* input */
 				:										/* clobbers: none */);
@@ -561,12 +801,56 @@ uxlen_t csr_read_indexed(size_t idx) {
 
 } /* namespace helpers */
 
-void csr_write_pmpaddr(size_t idx, uxlen_t value)
+/*
+ * Read all CSRs of [start, end] range into #out, unrolled into csrr sequence
+ * Returns number of CSRs read, nothing is read if #out is too small
+ */
+template <csr start, csr end>
+inline size_t csr_read_range(std::span<uxlen_t> out)
+{
+	static_assert(end >= start, "Invalid CSR range, end < start");
+
+	constexpr size_t start_idx = static_cast<size_t>(start);
+	constexpr size_t csr_count = static_cast<size_t>(end) - start_idx + 1;
+
+	if (out.size() < csr_count)
+		return 0;
+
+	[&]<size_t... I>(std::index_sequence<I...>) {
+		((out[I] = csr_read<static_cast<csr>(start_idx + I)>()), ...);
+	}(std::make_index_sequence<csr_count>{});
+
+	return csr_count;
+}
+
+/*
+ * Write all CSRs of [start, end] range from #in, unrolled into csrw sequence
+ * Returns number of CSRs written, nothing is written if #in is too small
+ */
+template <csr start, csr end>
+inline size_t csr_write_range(std::span<const uxlen_t> in)
+{
+	static_assert(end >= start, "Invalid CSR range, end < start");
+
+	constexpr size_t start_idx = static_cast<size_t>(start);
+	constexpr size_t csr_count = static_cast<size_t>(end) - start_idx + 1;
+
+	if (in.size() < csr_count)
+		return 0;
+
+	[&]<size_t... I>(std::index_sequence<I...>) {
+		(csr_write<static_cast<csr>(start_idx + I)>(in[I]), ...);
+	}(std::make_index_sequence<csr_count>{});
+
+	return csr_count;
+}
+
+inline void csr_write_pmpaddr(size_t idx, uxlen_t value)
 {
 	helpers::csr_write_indexed<csr::pmpaddr0, csr::pmpaddr15>(idx, value);
 }
 
-uxlen_t csr_read_pmpaddr(size_t idx)
+inline uxlen_t csr_read_pmpaddr(size_t idx)
 {
 	return helpers::csr_read_indexed<csr::pmpaddr0, csr::pmpaddr15>(idx);
 }
@@ -0,0 +1,254 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Dmitrii Lebed <lebed.dmitry@gmail.com>
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+/*
+ * CSR context save/restore
+ *
+ * csr_snapshot<regs...>() and csr_restore<regs...>() expand at compile time into
+ * a sequence of csrr/csrw instructions, CSR list is a template parameter pack so
+ * there are no calls, bounds checks or dispatch tables.
+ * CSRs are read and written in the listed order
+ */
+
+#ifndef BITFIELDSET_ARCH_RV_CSR_CONTEXT_H
+#define BITFIELDSET_ARCH_RV_CSR_CONTEXT_H
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <utility>
+#include "rv_csr.hpp"
+
+namespace rv {
+
+template <csr... regs>
+inline std::array<uxlen_t, sizeof...(regs)> csr_snapshot()
+{
+	constexpr std::array<csr, sizeof...(regs)> list = { regs... };
+	std::array<uxlen_t, sizeof...(regs)> values;
+
+	[&]<size_t... I>(std::index_sequence<I...>) {
+		((values[I] = csr_read<list[I]>()), ...);
+	}(std::make_index_sequence<sizeof...(regs)>{});
+
+	return values;
+}
+
+template <csr... regs>
+inline void csr_restore(const std::array<uxlen_t, sizeof...(regs)> &values)
+{
+	constexpr std::array<csr, sizeof...(regs)> list = { regs... };
+
+	[&]<size_t... I>(std::index_sequence<I...>) {
+		(csr_write<list[I]>(values[I]), ...);
+	}(std::make_index_sequence<sizeof...(regs)>{});
+}
+
+/* Compile time CSR list, snapshot storage is indexed with index<reg>() */
+template <csr... regs>
+struct csr_group {
+	static constexpr size_t count = sizeof...(regs);
+	static constexpr std::array<csr, count> list = { regs... };
+
+	using values = std::array<uxlen_t, count>;
+
+	template <csr reg>
+	static constexpr size_t index()
+	{
+		constexpr size_t idx = find(reg);
+
+		static_assert(idx < count, "CSR is not in the group");
+
+		return idx;
+	}
+
+	static values snapshot()
+	{
+		return csr_snapshot<regs...>();
+	}
+
+	static void restore(const values &v)
+	{
+		csr_restore<regs...>(v);
+	}
+
+private:
+	static constexpr size_t find(csr reg)
+	{
+		for (size_t i = 0; i < count; i++) {
+			if (list[i] == reg)
+				return i;
+		}
+
+		return count;
+	}
+};
+
+/* M-mode trap frame */
+using trap_frame_csrs = csr_group<
+	csr::mstatus,
+	csr::mepc,
+	csr::mcause,
+	csr::mtval
+>;
+
+/* S-mode context of a task/guest kernel, satp is restored last */
+using smode_csrs = csr_group<
+	csr::sstatus,
+	csr::sie,
+	csr::stvec,
+	csr::scounteren,
+	csr::senvcfg,
+	csr::sscratch,
+	csr::sepc,
+	csr::scause,
+	csr::stval,
+	csr::sip,
+	csr::satp
+>;
+
+/* H-mode vCPU context: hypervisor guest control and VS-mode CSRs, hgatp and vsatp are restored last */
+using hmode_csrs = csr_group<
+	csr::hstatus,
+	csr::hedeleg,
+	csr::hideleg,
+	csr::hvip,
+	csr::hie,
+	csr::hcounteren,
+	csr::hgeie,
+	csr::henvcfg,
+#if RV_XLEN == 32
+	csr::henvcfgh,
+#endif
+	csr::htimedelta,
+#if RV_XLEN == 32
+	csr::htimedeltah,
+#endif
+	csr::htval,
+	csr::htinst,
+	csr::vsstatus,
+	csr::vsie,
+	csr::vstvec,
+	csr::vsscratch,
+	csr::vsepc,
+	csr::vscause,
+	csr::vstval,
+	csr::vsip,
+	csr::hgatp,
+	csr::vsatp
+>;
+
+/*
+ * Lazy CSR context of a CSR group
+ *
+ * Context keeps CSR values in memory and tracks which of them were changed with set()
+ * since the last save()/restore(). On restore only changed CSRs are written, on switch
+ * from another context CSRs whose values match the values currently on the hart are
+ * skipped as well, so loading a context identical to the hart state is a no-op
+ */
+template <typename TGroup>
+class csr_context {
+public:
+	using group = TGroup;
+
+	static_assert(group::count <= 64, "dirty mask is limited to 64 CSRs");
+
+	template <csr reg>
+	uxlen_t get() const
+	{
+		return values[group::template index<reg>()];
+	}
+
+	/* Update in-memory value, CSR is marked dirty only if the value changes */
+	template <csr reg>
+	void set(uxlen_t value)
+	{
+		constexpr size_t idx = group::template index<reg>();
+
+		if (values[idx] != value) {
+			values[idx] = value;
+			dirty |= uint64_t{1} << idx;
+		}
+	}
+
+	template <csr reg>
+	bool is_dirty() const
+	{
+		return dirty & (uint64_t{1} << group::template index<reg>());
+	}
+
+	bool is_dirty() const
+	{
+		return dirty != 0;
+	}
+
+	/* Force write of all CSRs on next restore() (e.g. context moved to another hart) */
+	void mark_dirty()
+	{
+		dirty = all_mask;
+	}
+
+	/* Read all CSRs of the group from the hart, context becomes clean */
+	void save()
+	{
+		values = group::snapshot();
+		dirty = 0;
+	}
+
+	/* Write back CSRs changed since the last save()/restore(), context is resident on the hart */
+	void restore()
+	{
+		write_back(dirty);
+		dirty = 0;
+	}
+
+	/*
+	 * Load context onto the hart currently holding #current values (#current should be
+	 * saved after the hart was last running with it). Writes only CSRs which differ
+	 * from #current or were changed with set()
+	 */
+	void switch_from(const csr_context &current)
+	{
+		uint64_t changed = dirty;
+
+		for (size_t i = 0; i < group::count; i++) {
+			if (values[i] != current.values[i])
+				changed |= uint64_t{1} << i;
+		}
+
+		write_back(changed);
+		dirty = 0;
+	}
+
+	const typename group::values &data() const
+	{
+		return values;
+	}
+
+private:
+	static constexpr uint64_t all_mask = group::count == 64 ? ~uint64_t{0} :
+										 (uint64_t{1} << group::count) - 1;
+
+	/* one conditional csrw per CSR of the group, no dispatch */
+	void write_back(uint64_t mask) const
+	{
+		if (mask == 0)
+			return;
+
+		[&]<size_t... I>(std::index_sequence<I...>) {
+			((mask & (uint64_t{1} << I) ? csr_write<group::list[I]>(values[I]) : void()), ...);
+		}(std::make_index_sequence<group::count>{});
+	}
+
+	typename group::values values = {};
+	uint64_t dirty = 0;
+};
+
+/* Hypervisor vCPU CSR context */
+using vcpu_csr_context = csr_context<hmode_csrs>;
+
+} /* namespace rv */
+
+#endif /* BITFIELDSET_ARCH_RV_CSR_CONTEXT_H */
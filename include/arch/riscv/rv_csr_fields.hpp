@@ -0,0 +1,302 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Dmitrii Lebed <lebed.dmitry@gmail.com>
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+/*
+ * BitFieldSet layouts of machine mode CSRs
+ *
+ * CsrBitFieldSet provides BitFieldSet API over a CSR, field updates are mapped to
+ * CSR instructions instead of csrr + mask + csrw sequence:
+ *   - single bit field set: csrs/csrc (csrsi/csrci for bits 0..4), branch on the value
+ *     is folded away for constant values
+ *   - multi-bit field set: csrs of the new bits followed by csrc of the bits to clear,
+ *     so a trap in between sees old | new bits and the field is never cleared (mstatus.FS/VS
+ *     zero is Off and would make FP/vector instructions of the trap handler illegal)
+ *   - set covering all defined bits: csrw
+ *   - exchange(): csrrw/csrrs/csrrc, previous field value is returned
+ */
+
+#ifndef BITFIELDSET_ARCH_RV_CSR_FIELDS_H
+#define BITFIELDSET_ARCH_RV_CSR_FIELDS_H
+
+#include <cstdint>
+#include <cstddef>
+#include <bit>
+#include "../../bitfieldset.hpp"
+#include "rv_csr.hpp"
+
+namespace rv {
+
+struct MstatusDef {
+	enum FIELDS {
+		SIE,
+		MIE,
+		SPIE,
+		UBE,
+		MPIE,
+		SPP,
+		VS,
+		MPP,
+		FS,
+		XS,
+		MPRV,
+		SUM,
+		MXR,
+		TVM,
+		TW,
+		TSR,
+#if RV_XLEN == 64
+		UXL,
+		SXL,
+		SBE,
+		MBE,
+#endif
+		SD,
+
+		/* keep last */
+		FIELD_COUNT
+	};
+
+	using WordType = uxlen_t;
+
+	static constexpr size_t fieldCount = FIELD_COUNT;
+	static constexpr size_t wordCount = 1;
+
+	__extension__
+	static constexpr struct hal::BitField<WordType> layout[fieldCount] =
+	{
+		[SIE]	= { .word = 0,	.lsb = 1,	.msb = 1	},
+		[MIE]	= { .word = 0,	.lsb = 3,	.msb = 3	},
+		[SPIE]	= { .word = 0,	.lsb = 5,	.msb = 5	},
+		[UBE]	= { .word = 0,	.lsb = 6,	.msb = 6	},
+		[MPIE]	= { .word = 0,	.lsb = 7,	.msb = 7	},
+		[SPP]	= { .word = 0,	.lsb = 8,	.msb = 8	},
+		[VS]	= { .word = 0,	.lsb = 9,	.msb = 10	},
+		[MPP]	= { .word = 0,	.lsb = 11,	.msb = 12	},
+		[FS]	= { .word = 0,	.lsb = 13,	.msb = 14	},
+		[XS]	= { .word = 0,	.lsb = 15,	.msb = 16,	.access = hal::AccessType::READ_ONLY	},
+		[MPRV]	= { .word = 0,	.lsb = 17,	.msb = 17	},
+		[SUM]	= { .word = 0,	.lsb = 18,	.msb = 18	},
+		[MXR]	= { .word = 0,	.lsb = 19,	.msb = 19	},
+		[TVM]	= { .word = 0,	.lsb = 20,	.msb = 20	},
+		[TW]	= { .word = 0,	.lsb = 21,	.msb = 21	},
+		[TSR]	= { .word = 0,	.lsb = 22,	.msb = 22	},
+#if RV_XLEN == 64
+		[UXL]	= { .word = 0,	.lsb = 32,	.msb = 33	},
+		[SXL]	= { .word = 0,	.lsb = 34,	.msb = 35	},
+		[SBE]	= { .word = 0,	.lsb = 36,	.msb = 36	},
+		[MBE]	= { .word = 0,	.lsb = 37,	.msb = 37	},
+#endif
+		[SD]	= { .word = 0,	.lsb = RV_XLEN - 1,	.msb = RV_XLEN - 1,	.access = hal::AccessType::READ_ONLY	},
+	};
+};
+
+/* Interrupt bits shared by mie and mip */
+struct MieDef {
+	enum FIELDS {
+		SSIE,
+		MSIE,
+		STIE,
+		MTIE,
+		SEIE,
+		MEIE,
+		LCOFIE,
+
+		/* keep last */
+		FIELD_COUNT
+	};
+
+	using WordType = uxlen_t;
+
+	static constexpr size_t fieldCount = FIELD_COUNT;
+	static constexpr size_t wordCount = 1;
+
+	__extension__
+	static constexpr struct hal::BitField<WordType> layout[fieldCount] =
+	{
+		[SSIE]		= { .word = 0,	.lsb = 1,	.msb = 1	},
+		[MSIE]		= { .word = 0,	.lsb = 3,	.msb = 3	},
+		[STIE]		= { .word = 0,	.lsb = 5,	.msb = 5	},
+		[MTIE]		= { .word = 0,	.lsb = 7,	.msb = 7	},
+		[SEIE]		= { .word = 0,	.lsb = 9,	.msb = 9	},
+		[MEIE]		= { .word = 0,	.lsb = 11,	.msb = 11	},
+		[LCOFIE]	= { .word = 0,	.lsb = 13,	.msb = 13	},
+	};
+};
+
+/* Machine level pending bits are driven by the platform (CLINT/PLIC) and read-only */
+struct MipDef {
+	enum FIELDS {
+		SSIP,
+		MSIP,
+		STIP,
+		MTIP,
+		SEIP,
+		MEIP,
+		LCOFIP,
+
+		/* keep last */
+		FIELD_COUNT
+	};
+
+	using WordType = uxlen_t;
+
+	static constexpr size_t fieldCount = FIELD_COUNT;
+	static constexpr size_t wordCount = 1;
+
+	__extension__
+	static constexpr struct hal::BitField<WordType> layout[fieldCount] =
+	{
+		[SSIP]		= { .word = 0,	.lsb = 1,	.msb = 1	},
+		[MSIP]		= { .word = 0,	.lsb = 3,	.msb = 3,	.access = hal::AccessType::READ_ONLY	},
+		[STIP]		= { .word = 0,	.lsb = 5,	.msb = 5	},
+		[MTIP]		= { .word = 0,	.lsb = 7,	.msb = 7,	.access = hal::AccessType::READ_ONLY	},
+		[SEIP]		= { .word = 0,	.lsb = 9,	.msb = 9	},
+		[MEIP]		= { .word = 0,	.lsb = 11,	.msb = 11,	.access = hal::AccessType::READ_ONLY	},
+		[LCOFIP]	= { .word = 0,	.lsb = 13,	.msb = 13	},
+	};
+};
+
+/* mcause/scause */
+struct CauseDef {
+	enum FIELDS {
+		CODE,
+		INTERRUPT,
+
+		/* keep last */
+		FIELD_COUNT
+	};
+
+	using WordType = uxlen_t;
+
+	static constexpr size_t fieldCount = FIELD_COUNT;
+	static constexpr size_t wordCount = 1;
+
+	__extension__
+	static constexpr struct hal::BitField<WordType> layout[fieldCount] =
+	{
+		[CODE]		= { .word = 0,	.lsb = 0,			.msb = RV_XLEN - 2	},
+		[INTERRUPT]	= { .word = 0,	.lsb = RV_XLEN - 1,	.msb = RV_XLEN - 1	},
+	};
+};
+
+/* mtvec/stvec */
+struct TvecDef {
+	enum FIELDS {
+		MODE,
+		BASE,
+
+		/* keep last */
+		FIELD_COUNT
+	};
+
+	enum MODES {
+		MODE_DIRECT		= 0,
+		MODE_VECTORED	= 1,
+	};
+
+	using WordType = uxlen_t;
+
+	static constexpr size_t fieldCount = FIELD_COUNT;
+	static constexpr size_t wordCount = 1;
+
+	__extension__
+	static constexpr struct hal::BitField<WordType> layout[fieldCount] =
+	{
+		[MODE]	= { .word = 0,	.lsb = 0,	.msb = 1,	.max = MODE_VECTORED	},
+		[BASE]	= { .word = 0,	.lsb = 2,	.msb = RV_XLEN - 1	},
+	};
+};
+
+/*
+ * BitFieldSet storage policy mapped to CSR #reg
+ *
+ * Updates are done with set/clear CSR instructions, so every instruction is atomic
+ * against traps. Multi-bit update is two instructions, new bits are set first, so
+ * the intermediate field value is the union of old and new values.
+ * compareExchange() is not provided, there is no CSR compare-and-swap instruction
+ */
+template <csr reg>
+class csr_storage {
+public:
+	template <size_t idx>
+	uxlen_t load() const
+	{
+		static_assert(idx == 0, "CSR layout has single word");
+
+		return csr_read<reg>();
+	}
+
+	template <size_t idx>
+	void store(uxlen_t value)
+	{
+		static_assert(idx == 0, "CSR layout has single word");
+
+		csr_write<reg>(value);
+	}
+
+	template <size_t idx, uxlen_t mask>
+	void update(uxlen_t bits)
+	{
+		static_assert(idx == 0, "CSR layout has single word");
+
+		if constexpr (std::has_single_bit(mask)) {
+			if (bits)
+				csr_set<reg, mask>();
+			else
+				csr_clear<reg, mask>();
+		} else {
+			csr_set<reg>(bits);
+			csr_clear<reg>(mask & ~bits);
+		}
+	}
+};
+
+template <csr reg, typename TBitFieldDef>
+class CsrBitFieldSet : public hal::BitFieldSet<TBitFieldDef, csr_storage<reg>> {
+	static_assert(TBitFieldDef::wordCount == 1, "CSR layout has single word");
+
+public:
+	/*
+	 * Replace #field value, returns previous field value
+	 *
+	 * Field covering all defined bits is swapped with csrrw, single bit field
+	 * with csrrs/csrrc, other fields with csrrs of the new bits followed by csrc
+	 * of the bits to clear (intermediate value is old | new, see csr_storage)
+	 */
+	template <typename TBitFieldDef::FIELDS field>
+	uxlen_t exchange(uxlen_t value)
+	{
+		constexpr auto &entry = TBitFieldDef::layout[field];
+		constexpr uxlen_t mask = hal::bitMask<uxlen_t>(entry.lsb, entry.msb);
+		uxlen_t prev;
+
+		static_assert(entry.access == hal::AccessType::READ_WRITE, "exchange of non-RW field");
+
+		if constexpr (mask == hal::BitFieldSetUtil<TBitFieldDef>::definedMask(0)) {
+			prev = csr_swap<reg>(static_cast<uxlen_t>(value << entry.lsb) & mask);
+		} else if constexpr (std::has_single_bit(mask)) {
+			prev = value ? csr_read_set<reg, mask>() : csr_read_clear<reg, mask>();
+		} else {
+			const uxlen_t bits = static_cast<uxlen_t>(value << entry.lsb) & mask;
+
+			prev = csr_read_set<reg>(bits);
+			csr_clear<reg>(mask & ~bits);
+		}
+
+		return (prev & mask) >> entry.lsb;
+	}
+};
+
+using Mstatus = CsrBitFieldSet<csr::mstatus, MstatusDef>;
+using Mie = CsrBitFieldSet<csr::mie, MieDef>;
+using Mip = CsrBitFieldSet<csr::mip, MipDef>;
+using Mcause = CsrBitFieldSet<csr::mcause, CauseDef>;
+using Mtvec = CsrBitFieldSet<csr::mtvec, TvecDef>;
+using Scause = CsrBitFieldSet<csr::scause, CauseDef>;
+using Stvec = CsrBitFieldSet<csr::stvec, TvecDef>;
+
+} /* namespace rv */
+
+#endif /* BITFIELDSET_ARCH_RV_CSR_FIELDS_H */
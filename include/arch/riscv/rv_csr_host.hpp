@@ -0,0 +1,175 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Dmitrii Lebed <lebed.dmitry@gmail.com>
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+/*
+ * Host CSR emulation backend
+ *
+ * Selected with CONFIG_RV_CSR_HOST, routes CSR accessors of rv_csr.hpp to in-memory
+ * CSR file so CSR code could be built, tested and profiled on non-RISC-V hosts.
+ * XLEN is selected with CONFIG_RV_HOST_XLEN (32 or 64, default 64)
+ */
+
+#ifndef BITFIELDSET_ARCH_RV_CSR_HOST_H
+#define BITFIELDSET_ARCH_RV_CSR_HOST_H
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include "rv_types.hpp"
+
+namespace rv {
+
+enum class csr : uint16_t;
+
+namespace host {
+
+/*
+ * Side-effect hooks, called instead of plain CSR value access
+ * Read hook returns the value seen by the reader and may update stored value,
+ * write hook stores (or ignores) the written value
+ */
+using csr_read_hook = uxlen_t (*)(csr reg, uxlen_t &stored);
+using csr_write_hook = void (*)(csr reg, uxlen_t &stored, uxlen_t value);
+
+/* Read-to-clear CSR */
+inline uxlen_t csr_read_to_clear(csr, uxlen_t &stored)
+{
+	uxlen_t res = stored;
+
+	stored = 0;
+
+	return res;
+}
+
+/* Counter incremented on every read */
+inline uxlen_t csr_read_tick(csr, uxlen_t &stored)
+{
+	return stored++;
+}
+
+/* Read-only CSR, writes are ignored */
+inline void csr_write_ignore(csr, uxlen_t &, uxlen_t)
+{
+}
+
+class csr_file {
+public:
+	static constexpr size_t csr_count = 4096;
+
+	uxlen_t read(csr reg)
+	{
+		entry &e = entries[index(reg)];
+
+		e.reads++;
+
+		return e.on_read ? e.on_read(reg, e.value) : e.value;
+	}
+
+	void write(csr reg, uxlen_t value)
+	{
+		entry &e = entries[index(reg)];
+
+		e.writes++;
+
+		if (e.on_write)
+			e.on_write(reg, e.value, value);
+		else
+			e.value = value;
+	}
+
+	/* Read-modify-write CSR instructions, previous value is returned */
+	uxlen_t swap(csr reg, uxlen_t value)
+	{
+		uxlen_t res = read(reg);
+
+		write(reg, value);
+
+		return res;
+	}
+
+	uxlen_t set_bits(csr reg, uxlen_t mask)
+	{
+		uxlen_t res = read(reg);
+
+		write(reg, res | mask);
+
+		return res;
+	}
+
+	uxlen_t clear_bits(csr reg, uxlen_t mask)
+	{
+		uxlen_t res = read(reg);
+
+		write(reg, res & ~mask);
+
+		return res;
+	}
+
+	/* Value access without side effects and access counting */
+	uxlen_t peek(csr reg) const
+	{
+		return entries[index(reg)].value;
+	}
+
+	void poke(csr reg, uxlen_t value)
+	{
+		entries[index(reg)].value = value;
+	}
+
+	uint64_t read_count(csr reg) const
+	{
+		return entries[index(reg)].reads;
+	}
+
+	uint64_t write_count(csr reg) const
+	{
+		return entries[index(reg)].writes;
+	}
+
+	void set_hooks(csr reg, csr_read_hook on_read, csr_write_hook on_write = nullptr)
+	{
+		entries[index(reg)].on_read = on_read;
+		entries[index(reg)].on_write = on_write;
+	}
+
+	void reset_counters()
+	{
+		for (auto &e : entries) {
+			e.reads = 0;
+			e.writes = 0;
+		}
+	}
+
+	/* Clear values, counters and hooks of all CSRs */
+	void reset()
+	{
+		entries = {};
+	}
+
+private:
+	struct entry {
+		uxlen_t value;
+		uint64_t reads;
+		uint64_t writes;
+		csr_read_hook on_read;
+		csr_write_hook on_write;
+	};
+
+	static constexpr size_t index(csr reg)
+	{
+		return static_cast<size_t>(reg) % csr_count;
+	}
+
+	std::array<entry, csr_count> entries = {};
+};
+
+/* CSR file of the emulated hart */
+inline csr_file hart_csrs;
+
+} /* namespace host */
+
+} /* namespace rv */
+
+#endif /* BITFIELDSET_ARCH_RV_CSR_HOST_H */
@@ -8,16 +8,24 @@
 
 #include <stdint.h>
 
-#ifndef __riscv
+#if defined(__riscv)
+#define RV_XLEN __riscv_xlen
+#elif defined(CONFIG_RV_CSR_HOST)
+/* host CSR emulation, see rv_csr_host.hpp */
+#ifndef CONFIG_RV_HOST_XLEN
+#define CONFIG_RV_HOST_XLEN 64
+#endif
+#define RV_XLEN CONFIG_RV_HOST_XLEN
+#else
 #error "Including RISC-V header on non-RISC-V platform"
 #endif
 
 namespace rv {
 
-#if __riscv_xlen == 32
+#if RV_XLEN == 32
 using uxlen_t = uint32_t;
 using xlen_t = int32_t;
-#elif __riscv_xlen == 64
+#elif RV_XLEN == 64
 using uxlen_t = uint64_t;
 using xlen_t = int64_t;
 #else
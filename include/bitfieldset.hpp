@@ -21,13 +21,40 @@
 #include <cassert>
 #include <type_traits>
 #include <algorithm>
+#include <utility>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <functional>
 
 #include "hal_common.hpp"
 
+/*
+ * pext/pdep based unpack()/pack() are opt-in: fields still have to be shifted out of the
+ * extracted value one by one, so the scalar path is usually as fast or faster
+ * (see bench/bench_unpack.cpp)
+ */
+#if defined(__BMI2__) && defined(CONFIG_BITFIELDSET_BMI2)
+#define BITFIELDSET_BMI2 1
+#include <immintrin.h>
+#else
+#define BITFIELDSET_BMI2 0
+#endif
+
 namespace hal {
 
 inline constexpr size_t BITFIELD_OFFSET_UNDEFINED = std::numeric_limits<size_t>::max();
 
+/** Initial value of the cached word in mutable word accessor */
+enum class WordInit {
+	/** read current word value */
+	READ,
+	/** start from zero, no read is performed */
+	ZERO,
+	/** start from default values of the fields, no read is performed */
+	DEFAULT,
+};
+
 /**
  * Bit field layout definition structure
  *
@@ -70,6 +97,22 @@ struct BitField {
 				  "Underlying bit field type should be unsigned");
 };
 
+/**
+ * Runtime location of a bit field, entry of BitFieldSetUtil::fieldLocations() table
+ *
+ * @tparam TWord underlying bit field type (word)
+ */
+template <typename TWord>
+struct BitFieldLocation {
+	/** word index */
+	uint16_t	word;
+	/** field shift in word (least significant bit) */
+	uint8_t		shift;
+	/** access type allowed for bit field */
+	AccessType	access;
+	/** field mask in word */
+	TWord		mask;
+};
 
 template <typename TBitFieldDef>
 class BitFieldSetUtil {
@@ -139,7 +182,7 @@ public:
 	static constexpr bool isDefaultValueConsistent()
 	{
 		for (auto const &entry : TBitFieldDef::layout) {
-			const TWord mask = bitMask<TWord>(entry.lsb, entry.msb) >> entry.lsb;
+			const TWord mask = static_cast<TWord>(bitMask<TWord>(entry.lsb, entry.msb) >> entry.lsb);
 
 			if ((entry.def & mask) != entry.def) {
 				return false;
@@ -152,7 +195,7 @@ public:
 	static constexpr bool isValueBoundsConsistent()
 	{
 		for (auto const &entry : TBitFieldDef::layout) {
-			const TWord mask = bitMask<TWord>(entry.lsb, entry.msb) >> entry.lsb;
+			const TWord mask = static_cast<TWord>(bitMask<TWord>(entry.lsb, entry.msb) >> entry.lsb);
 
 			if ((entry.min & mask) != entry.min ||
 				(entry.max & mask) != entry.max ||
@@ -164,6 +207,203 @@ public:
 		return true;
 	}
 
+	/** mask of all bits of word #idx which belong to any field */
+	static constexpr TWord definedMask(size_t idx)
+	{
+		TWord mask = 0;
+
+		for (auto const &entry : TBitFieldDef::layout) {
+			if (entry.word == idx) {
+				mask |= bitMask<TWord>(entry.lsb, entry.msb);
+			}
+		}
+
+		return mask;
+	}
+
+	/** defined bits masks of all words in memory byte order, reserved bits are zero */
+	static constexpr std::array<TWord, TBitFieldDef::wordCount> definedImage()
+	{
+		std::array<TWord, TBitFieldDef::wordCount> image = {};
+
+		for (size_t i = 0; i < TBitFieldDef::wordCount; i++) {
+			image[i] = toMemory(definedMask(i));
+		}
+
+		return image;
+	}
+
+	/** mask of most significant bits of all fields located in word #idx (SWAR guard bits) */
+	static constexpr TWord fieldMsbMask(size_t idx)
+	{
+		TWord mask = 0;
+
+		for (auto const &entry : TBitFieldDef::layout) {
+			if (entry.word == idx) {
+				mask |= bit<TWord>(entry.msb);
+			}
+		}
+
+		return mask;
+	}
+
+	/** mask of least significant bits of all fields located in word #idx */
+	static constexpr TWord fieldLsbMask(size_t idx)
+	{
+		TWord mask = 0;
+
+		for (auto const &entry : TBitFieldDef::layout) {
+			if (entry.word == idx) {
+				mask |= bit<TWord>(entry.lsb);
+			}
+		}
+
+		return mask;
+	}
+
+	/** width of all fields located in word #idx if it is the same, 0 otherwise */
+	static constexpr size_t uniformFieldWidth(size_t idx)
+	{
+		size_t width = 0;
+
+		for (auto const &entry : TBitFieldDef::layout) {
+			if (entry.word == idx) {
+				const size_t w = entry.msb - entry.lsb + 1;
+
+				if (width != 0 && width != w) {
+					return 0;
+				}
+
+				width = w;
+			}
+		}
+
+		return width;
+	}
+
+	/** check for overlaps between all fields of word #idx, including ones allowed to overlap */
+	static constexpr bool hasOverlappingFieldsInWord(size_t idx)
+	{
+		TWord used = 0;
+
+		for (auto const &entry : TBitFieldDef::layout) {
+			if (entry.word == idx) {
+				const TWord mask = bitMask<TWord>(entry.lsb, entry.msb);
+
+				if ((used & mask) != 0) {
+					return true;
+				}
+
+				used |= mask;
+			}
+		}
+
+		return false;
+	}
+
+	/** mask of bits of word #idx which belong to fields allowing #access (READ_ONLY or WRITE_ONLY) */
+	static constexpr TWord accessMask(size_t idx, AccessType access)
+	{
+		TWord mask = 0;
+
+		for (auto const &entry : TBitFieldDef::layout) {
+			if (entry.word == idx &&
+				(static_cast<unsigned>(entry.access) & static_cast<unsigned>(access)) != 0) {
+				mask |= bitMask<TWord>(entry.lsb, entry.msb);
+			}
+		}
+
+		return mask;
+	}
+
+	/** word value composed of default values of all fields located in word #idx */
+	static constexpr TWord defaultWord(size_t idx)
+	{
+		TWord value = 0;
+
+		for (auto const &entry : TBitFieldDef::layout) {
+			if (entry.word == idx) {
+				value |= static_cast<TWord>(entry.def << entry.lsb);
+			}
+		}
+
+		return value;
+	}
+
+	/** image of all words composed of field default values (e.g. POR values of registers) */
+	static constexpr std::array<TWord, TBitFieldDef::wordCount> defaultImage()
+	{
+		std::array<TWord, TBitFieldDef::wordCount> image = {};
+
+		for (size_t i = 0; i < TBitFieldDef::wordCount; i++) {
+			image[i] = defaultWord(i);
+		}
+
+		return image;
+	}
+
+	/** byte order of words in memory, TBitFieldDef::endian if defined, native otherwise */
+	static constexpr std::endian byteOrder()
+	{
+		if constexpr (requires { TBitFieldDef::endian; }) {
+			return TBitFieldDef::endian;
+		} else {
+			return std::endian::native;
+		}
+	}
+
+	static constexpr bool needsByteSwap()
+	{
+		return sizeof(TWord) > 1 && byteOrder() != std::endian::native;
+	}
+
+	/**
+	 * Native word converted to memory byte order
+	 *
+	 * Constant words (masks, default values) are converted at compile time, so masking
+	 * and comparing memory words against them needs no byte swap at runtime
+	 */
+	static constexpr TWord toMemory(TWord word)
+	{
+		if constexpr (!needsByteSwap()) {
+			return word;
+		} else if constexpr (sizeof(TWord) == sizeof(uint16_t)) {
+			return __builtin_bswap16(word);
+		} else if constexpr (sizeof(TWord) == sizeof(uint32_t)) {
+			return __builtin_bswap32(word);
+		} else {
+			return __builtin_bswap64(word);
+		}
+	}
+
+	/** memory word converted to native byte order */
+	static constexpr TWord fromMemory(TWord word)
+	{
+		return toMemory(word);
+	}
+
+	/** {word, shift, mask} table of all fields, used by runtime field index accessors */
+	static constexpr std::array<BitFieldLocation<TWord>, TBitFieldDef::fieldCount> fieldLocations()
+	{
+		std::array<BitFieldLocation<TWord>, TBitFieldDef::fieldCount> table = {};
+
+		static_assert(TBitFieldDef::wordCount <= std::numeric_limits<uint16_t>::max(),
+					  "Word count does not fit field location table");
+
+		for (size_t i = 0; i < TBitFieldDef::fieldCount; i++) {
+			const auto &entry = TBitFieldDef::layout[i];
+
+			table[i] = {
+				.word = static_cast<uint16_t>(entry.word),
+				.shift = entry.lsb,
+				.access = entry.access,
+				.mask = bitMask<TWord>(entry.lsb, entry.msb),
+			};
+		}
+
+		return table;
+	}
+
 private:
 	template <typename T, size_t N>
 	static constexpr size_t arraySize(T (&)[N]) { return N; }
@@ -178,183 +418,1740 @@ private:
 	static constexpr size_t wordBits = std::numeric_limits<TWord>::digits;
 };
 
-template <typename TBitFieldDef, size_t TWordIdx>
-class BitFieldWordConstImpl {
+/**
+ * Default bit field set storage policy
+ *
+ * Storage policy defines how BitFieldSet words are kept and accessed.
+ * Policy provides load(), store() and update() word accessors (volatile qualified
+ * overloads are optional), word index and update mask are compile time parameters.
+ * Words and masks are passed in memory byte order, see BitFieldSetUtil::byteOrder()
+ */
+template <typename TBitFieldDef>
+struct BitFieldStorage {
 	using TWord = typename TBitFieldDef::WordType;
 
-public:
-	constexpr explicit BitFieldWordConstImpl(TWord word) noexcept
-		: cachedWord(word)
+	template <size_t TWordIdx>
+	constexpr TWord load() const
 	{
+		return words[TWordIdx];
 	}
 
-	template <typename TBitFieldDef::FIELDS field>
-	constexpr const BitFieldWordConstImpl &get(TWord &value) const noexcept
+	template <size_t TWordIdx>
+	constexpr TWord load() const volatile
 	{
-		static_assert(TBitFieldDef::layout[field].word == TWordIdx,
-					  "cascading field accessors from different words");
-
-		const auto &entry = TBitFieldDef::layout[field];
-		const TWord mask = bitMask<TWord>(entry.lsb, entry.msb);
+		return words[TWordIdx];
+	}
 
-		static_assert(entry.access != AccessType::WRITE_ONLY, "reading from WO field");
+	template <size_t TWordIdx>
+	constexpr void store(TWord value)
+	{
+		words[TWordIdx] = value;
+	}
 
-		value = (cachedWord & mask) >> entry.lsb;
+	template <size_t TWordIdx>
+	constexpr void store(TWord value) volatile
+	{
+		words[TWordIdx] = value;
+	}
 
-		return *this;
+	/** replace #mask bits of the word with #bits using single load and store */
+	template <size_t TWordIdx, TWord mask>
+	constexpr void update(TWord bits)
+	{
+		words[TWordIdx] = static_cast<TWord>((words[TWordIdx] & ~mask) | bits);
 	}
 
-	template <typename TBitFieldDef::FIELDS field>
-	constexpr TWord get() const noexcept
+	template <size_t TWordIdx, TWord mask>
+	constexpr void update(TWord bits) volatile
 	{
-		TWord value;
+		words[TWordIdx] = static_cast<TWord>((words[TWordIdx] & ~mask) | bits);
+	}
 
-		get<field>(value);
+	/**
+	 * replace #mask bits of the word with #desired if they are equal to #expected,
+	 * otherwise #expected is updated with current #mask bits of the word
+	 */
+	template <size_t TWordIdx, TWord mask>
+	constexpr bool compareExchange(TWord &expected, TWord desired)
+	{
+		return compareExchangeWord<mask>(words[TWordIdx], expected, desired);
+	}
 
-		return value;
+	template <size_t TWordIdx, TWord mask>
+	constexpr bool compareExchange(TWord &expected, TWord desired) volatile
+	{
+		return compareExchangeWord<mask>(words[TWordIdx], expected, desired);
 	}
 
+	TWord words[TBitFieldDef::wordCount];
+
 private:
-	const TWord cachedWord;
+	template <TWord mask, typename TRawWord>
+	static constexpr bool compareExchangeWord(TRawWord &word, TWord &expected, TWord desired)
+	{
+		const TWord value = word;
+
+		if ((value & mask) != expected) {
+			expected = value & mask;
+			return false;
+		}
+
+		word = static_cast<TWord>((value & ~mask) | desired);
+
+		return true;
+	}
 };
 
+template <typename TBitFieldDef, typename TStorage = BitFieldStorage<TBitFieldDef>>
+class BitFieldSet;
+
+/**
+ * Shadow-backed storage policy for write-only and write-mostly registers
+ *
+ * Keeps non-volatile copy of the device words. Updates are merged into the shadow and
+ * written to the device with a single store, so the device is never read on update.
+ * Reads of words holding read-only (hardware driven) fields go to the device, other
+ * words are read from the shadow. attach() initializes the shadow with field default
+ * values and reloads readable bits from the device, sync() could be used to refresh them later
+ */
 template <typename TBitFieldDef>
-class BitFieldSet : public TBitFieldDef {
+class BitFieldStorageShadow {
 public:
 	using TWord = typename TBitFieldDef::WordType;
 
-	template <typename TBitFieldDef::FIELDS field>
-	constexpr auto word() const
+	constexpr void attach(volatile BitFieldSet<TBitFieldDef> &dev)
 	{
-		return BitFieldWordConst<field>(raw[wordIdx(field)]);
+		constexpr auto image = Util::defaultImage();
+
+		device = &dev.storage();
+
+		for (size_t i = 0; i < TBitFieldDef::wordCount; i++) {
+			shadow[i] = Util::toMemory(image[i]);
+		}
+
+		sync();
 	}
 
-	template <typename TBitFieldDef::FIELDS field>
-	constexpr auto word() const volatile
+	/** reload readable bits of the shadow, words without readable fields are not accessed */
+	constexpr void sync()
 	{
-		return BitFieldWordConst<field>(raw[wordIdx(field)]);
+		[&]<size_t... I>(std::index_sequence<I...>) {
+			(syncWord<I>(), ...);
+		}(std::make_index_sequence<TBitFieldDef::wordCount>{});
 	}
 
-	template <typename TBitFieldDef::FIELDS field>
-	consteval auto constWord() const
+	template <size_t TWordIdx>
+	constexpr TWord load() const
 	{
-		return word<field>();
+		if constexpr (isDeviceWord(TWordIdx)) {
+			return device->template load<TWordIdx>();
+		} else {
+			return shadow[TWordIdx];
+		}
 	}
 
-	template <typename TBitFieldDef::FIELDS field>
-	consteval auto constWord() const volatile
+	template <size_t TWordIdx>
+	constexpr void store(TWord value)
 	{
-		return word<field>();
+		shadow[TWordIdx] = value;
+		device->template store<TWordIdx>(value);
 	}
 
-	template <typename TBitFieldDef::FIELDS field>
-	constexpr void set(TWord value)
+	template <size_t TWordIdx, TWord mask>
+	constexpr void update(TWord bits)
 	{
-		const size_t idx = wordIdx(field);
-		const auto &entry = TBitFieldDef::layout[field];
-		const TWord mask = bitMask<TWord>(entry.lsb, entry.msb);
-		TWord &word = raw[idx];
-
-		static_assert(entry.access != AccessType::READ_ONLY, "writing to RO field");
-
-		word &= ~mask;
-		word |= (value << entry.lsb) & mask;
+		store<TWordIdx>(static_cast<TWord>((shadow[TWordIdx] & ~mask) | bits));
 	}
 
-	template <typename TBitFieldDef::FIELDS field>
-	constexpr void set(TWord value) volatile
+	template <size_t TWordIdx, TWord mask>
+	constexpr bool compareExchange(TWord &expected, TWord desired)
 	{
-		const size_t idx = wordIdx(field);
-		const auto &entry = TBitFieldDef::layout[field];
-		const TWord mask = bitMask<TWord>(entry.lsb, entry.msb);
-		volatile TWord &word = raw[idx];
+		const TWord value = load<TWordIdx>();
 
-		static_assert(entry.access != AccessType::READ_ONLY, "writing to RO field");
+		if ((value & mask) != expected) {
+			expected = value & mask;
+			return false;
+		}
 
-		word &= ~mask;
-		word |= (value << entry.lsb) & mask;
+		update<TWordIdx, mask>(desired);
+
+		return true;
 	}
 
-	template <typename TBitFieldDef::FIELDS field>
-	constexpr TWord get() const
-	{
-		const size_t idx = wordIdx(field);
-		const auto &entry = TBitFieldDef::layout[field];
-		const TWord mask = bitMask<TWord>(entry.lsb, entry.msb);
-		const TWord &word = raw[idx];
+private:
+	using Util = BitFieldSetUtil<TBitFieldDef>;
 
-		static_assert(entry.access != AccessType::WRITE_ONLY, "reading from WO field");
+	/** word #idx holds read-only fields, their value is owned by hardware and not cached */
+	static constexpr bool isDeviceWord(size_t idx)
+	{
+		for (auto const &entry : TBitFieldDef::layout) {
+			if (entry.word == idx && entry.access == AccessType::READ_ONLY) {
+				return true;
+			}
+		}
 
-		return (word & mask) >> entry.lsb;
+		return false;
 	}
 
-	template <typename TBitFieldDef::FIELDS field>
-	constexpr TWord get() const volatile
+	template <size_t TWordIdx>
+	constexpr void syncWord()
 	{
-		const size_t idx = wordIdx(field);
-		const auto &entry = TBitFieldDef::layout[field];
-		const TWord mask = bitMask<TWord>(entry.lsb, entry.msb);
-		const volatile TWord &word = raw[idx];
+		constexpr TWord readable = Util::toMemory(Util::accessMask(TWordIdx, AccessType::READ_ONLY));
 
-		static_assert(entry.access != AccessType::WRITE_ONLY, "reading from WO field");
+		if constexpr (readable != 0) {
+			const TWord value = device->template load<TWordIdx>();
 
-		return (word & mask) >> entry.lsb;
+			shadow[TWordIdx] = static_cast<TWord>((shadow[TWordIdx] & ~readable) | (value & readable));
+		}
 	}
 
-	template <typename TBitFieldDef::FIELDS field>
-	constexpr auto get(TWord &value) const
+	TWord shadow[TBitFieldDef::wordCount];
+	volatile BitFieldStorage<TBitFieldDef> *device;
+};
+
+/**
+ * Dirty-tracked storage policy for working copies of register blocks
+ *
+ * Every word written through the bit field set is marked in the dirty bitmap,
+ * flushTo() writes marked words only to the device and clears the bitmap
+ */
+template <typename TBitFieldDef>
+class BitFieldStorageDirty {
+public:
+	using TWord = typename TBitFieldDef::WordType;
+
+	template <size_t TWordIdx>
+	constexpr TWord load() const
 	{
-		auto w = word<field>();
+		return words[TWordIdx];
+	}
 
-		w.template get<field>(value);
+	template <size_t TWordIdx>
+	constexpr void store(TWord value)
+	{
+		words[TWordIdx] = value;
+		markDirty(TWordIdx);
+	}
 
-		return w;
+	template <size_t TWordIdx, TWord mask>
+	constexpr void update(TWord bits)
+	{
+		store<TWordIdx>(static_cast<TWord>((words[TWordIdx] & ~mask) | bits));
 	}
 
-	template <typename TBitFieldDef::FIELDS field>
-	constexpr auto get(TWord &value) const volatile
+	template <size_t TWordIdx, TWord mask>
+	constexpr bool compareExchange(TWord &expected, TWord desired)
 	{
-		auto w = word<field>();
+		if ((words[TWordIdx] & mask) != expected) {
+			expected = words[TWordIdx] & mask;
+			return false;
+		}
 
-		w.template get<field>(value);
+		update<TWordIdx, mask>(desired);
 
-		return w;
+		return true;
 	}
 
-	constexpr void resetAll()
+	constexpr bool isDirty(size_t idx) const
 	{
-		std::fill_n(raw, TBitFieldDef::wordCount, 0);
+		return (dirty[idx / chunkBits] & bit<uint64_t>(idx % chunkBits)) != 0;
 	}
 
-	constexpr void resetAll() volatile
+	/** write dirty words to #dev and clear the dirty bitmap */
+	void flushTo(volatile BitFieldSet<TBitFieldDef> &dev)
+	{
+		volatile TWord *out = dev.storage().words;
+
+		for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+			uint64_t pending = dirty[chunk];
+
+			while (pending != 0) {
+				const size_t idx = chunk * chunkBits + static_cast<size_t>(std::countr_zero(pending));
+
+				out[idx] = words[idx];
+				pending &= pending - 1;
+			}
+
+			dirty[chunk] = 0;
+		}
+	}
+
+	/**
+	 * Write words containing #fields to #dev and clear their dirty bits
+	 *
+	 * Set of words is known at compile time, so the flush is a straight run of stores
+	 * without bitmap checks
+	 */
+	template <typename TBitFieldDef::FIELDS... fields>
+	void flushTo(volatile BitFieldSet<TBitFieldDef> &dev)
 	{
-		std::fill_n(raw, TBitFieldDef::wordCount, 0);
+		[&]<size_t... I>(std::index_sequence<I...>) {
+			(flushWord<I, fields...>(dev), ...);
+		}(std::make_index_sequence<TBitFieldDef::wordCount>{});
+
+		[&]<size_t... I>(std::index_sequence<I...>) {
+			((dirty[I] &= ~chunkMask<fields...>(I)), ...);
+		}(std::make_index_sequence<chunkCount>{});
 	}
 
+	TWord words[TBitFieldDef::wordCount];
+
 private:
-	using Util = BitFieldSetUtil<TBitFieldDef>;
+	static constexpr size_t chunkBits = std::numeric_limits<uint64_t>::digits;
+	static constexpr size_t chunkCount = (TBitFieldDef::wordCount + chunkBits - 1) / chunkBits;
 
-	static constexpr size_t wordIdx(typename TBitFieldDef::FIELDS field)
+	constexpr void markDirty(size_t idx)
 	{
-		return TBitFieldDef::layout[static_cast<size_t>(field)].word;
+		dirty[idx / chunkBits] |= bit<uint64_t>(idx % chunkBits);
 	}
 
-	template <typename TBitFieldDef::FIELDS field>
-	using BitFieldWordConst = BitFieldWordConstImpl<TBitFieldDef, wordIdx(field)>;
+	template <size_t TWordIdx, typename TBitFieldDef::FIELDS... fields>
+	void flushWord(volatile BitFieldSet<TBitFieldDef> &dev)
+	{
+		if constexpr (((TBitFieldDef::layout[fields].word == TWordIdx) || ...)) {
+			dev.storage().words[TWordIdx] = words[TWordIdx];
+		}
+	}
 
-	/* Compile-time consistency checks */
-	static_assert(Util::isWordIdxWithinBounds(), "Word index is not within defined range");
-	static_assert(Util::isBitIndexWithinTypeBounds(), "Bit index is out of word type bounds");
-	static_assert(!Util::hasOverlappingFields(), "Bit fields are overlapping");
-	static_assert(Util::isByteOffsetConsistent(),
-				  "Byte offset value is not consistent with word value");
-	static_assert(Util::isDefaultValueConsistent(), "Default value is not consistent with bitmask");
-	static_assert(Util::isValueBoundsConsistent(), "Value bounds (min/max) are not consistent");
+	/** dirty bitmap chunk #chunk bits of words containing #fields */
+	template <typename TBitFieldDef::FIELDS... fields>
+	static constexpr uint64_t chunkMask(size_t chunk)
+	{
+		uint64_t mask = 0;
 
-	/* bit field underlying raw storage */
-	TWord raw[TBitFieldDef::wordCount];
+		for (const size_t idx : { TBitFieldDef::layout[fields].word... }) {
+			if (idx / chunkBits == chunk) {
+				mask |= bit<uint64_t>(idx % chunkBits);
+			}
+		}
+
+		return mask;
+	}
+
+	uint64_t dirty[chunkCount] = {};
+};
+
+/**
+ * Atomic storage policy
+ *
+ * Words are accessed through std::atomic_ref: partial word updates are done with CAS loop,
+ * single bit updates with fetch_or()/fetch_and() and full word updates with plain atomic store.
+ * Loads use the strongest load-compatible order derived from #order
+ *
+ * @tparam order memory order of word updates
+ */
+template <typename TBitFieldDef, std::memory_order order = std::memory_order_seq_cst>
+struct BitFieldStorageAtomic {
+	using TWord = typename TBitFieldDef::WordType;
+
+	template <size_t TWordIdx>
+	constexpr TWord load() const
+	{
+		if (std::is_constant_evaluated()) {
+			return words[TWordIdx];
+		}
+
+		return std::atomic_ref<const TWord>(words[TWordIdx]).load(loadOrder);
+	}
+
+	template <size_t TWordIdx>
+	constexpr void store(TWord value)
+	{
+		if (std::is_constant_evaluated()) {
+			words[TWordIdx] = value;
+			return;
+		}
+
+		std::atomic_ref<TWord>(words[TWordIdx]).store(value, storeOrder);
+	}
+
+	template <size_t TWordIdx, TWord mask>
+	constexpr void update(TWord bits)
+	{
+		if (std::is_constant_evaluated()) {
+			words[TWordIdx] = static_cast<TWord>((words[TWordIdx] & ~mask) | bits);
+			return;
+		}
+
+		std::atomic_ref<TWord> word(words[TWordIdx]);
+
+		if constexpr (mask == std::numeric_limits<TWord>::max()) {
+			word.store(bits, storeOrder);
+		} else if constexpr (std::has_single_bit(mask)) {
+			if (bits != 0) {
+				word.fetch_or(mask, order);
+			} else {
+				word.fetch_and(static_cast<TWord>(~mask), order);
+			}
+		} else {
+			TWord expected = word.load(std::memory_order_relaxed);
+
+			while (!word.compare_exchange_weak(expected, static_cast<TWord>((expected & ~mask) | bits),
+											   order, loadOrder)) {
+			}
+		}
+	}
+
+	/** single CAS on the word, retried only while #mask bits keep matching #expected */
+	template <size_t TWordIdx, TWord mask>
+	constexpr bool compareExchange(TWord &expected, TWord desired)
+	{
+		if (std::is_constant_evaluated()) {
+			if ((words[TWordIdx] & mask) != expected) {
+				expected = words[TWordIdx] & mask;
+				return false;
+			}
+
+			words[TWordIdx] = static_cast<TWord>((words[TWordIdx] & ~mask) | desired);
+			return true;
+		}
+
+		std::atomic_ref<TWord> word(words[TWordIdx]);
+		TWord current = word.load(loadOrder);
+
+		do {
+			if ((current & mask) != expected) {
+				expected = current & mask;
+				return false;
+			}
+		} while (!word.compare_exchange_weak(current, static_cast<TWord>((current & ~mask) | desired),
+											 order, loadOrder));
+
+		return true;
+	}
+
+	alignas(std::atomic_ref<TWord>::required_alignment) TWord words[TBitFieldDef::wordCount];
+
+private:
+	static constexpr std::memory_order loadOrder =
+		order == std::memory_order_release ? std::memory_order_relaxed :
+		order == std::memory_order_acq_rel ? std::memory_order_acquire : order;
+	static constexpr std::memory_order storeOrder =
+		order == std::memory_order_acquire || order == std::memory_order_consume ? std::memory_order_relaxed :
+		order == std::memory_order_acq_rel ? std::memory_order_release : order;
+
+	static_assert(std::atomic_ref<TWord>::required_alignment <= sizeof(TWord),
+				  "Word type could not be accessed atomically within word array");
+	static_assert(std::atomic_ref<TWord>::is_always_lock_free, "Word type atomic access is not lock free");
+};
+
+template <typename TBitFieldDef, size_t TWordIdx>
+class BitFieldWordConstImpl {
+	using TWord = typename TBitFieldDef::WordType;
+
+public:
+	constexpr explicit BitFieldWordConstImpl(TWord word) noexcept
+		: cachedWord(word)
+	{
+	}
+
+	template <typename TBitFieldDef::FIELDS field>
+	constexpr const BitFieldWordConstImpl &get(TWord &value) const noexcept
+	{
+		static_assert(TBitFieldDef::layout[field].word == TWordIdx,
+					  "cascading field accessors from different words");
+
+		const auto &entry = TBitFieldDef::layout[field];
+		const TWord mask = bitMask<TWord>(entry.lsb, entry.msb);
+
+		static_assert(entry.access != AccessType::WRITE_ONLY, "reading from WO field");
+
+		value = static_cast<TWord>((cachedWord & mask) >> entry.lsb);
+
+		return *this;
+	}
+
+	template <typename TBitFieldDef::FIELDS field>
+	constexpr TWord get() const noexcept
+	{
+		TWord value;
+
+		get<field>(value);
+
+		return value;
+	}
+
+private:
+	const TWord cachedWord;
+};
+
+/**
+ * SIMD within a register (SWAR) arithmetic over all fields of a word
+ *
+ * Every field of word #TWordIdx is treated as an independent unsigned lane, carries are
+ * stopped at field boundaries using compile time guard masks (most significant bits of fields).
+ * Operations take and return whole words, bits outside of fields are taken from the first operand
+ */
+template <typename TBitFieldDef, size_t TWordIdx>
+class BitFieldSwarImpl {
+	using TWord = typename TBitFieldDef::WordType;
+	using Util = BitFieldSetUtil<TBitFieldDef>;
+
+public:
+	/** bits of all fields in the word */
+	static constexpr TWord fieldsMask = Util::definedMask(TWordIdx);
+
+	/** #value replicated into every field, value should fit into the narrowest field */
+	static constexpr TWord splat(TWord value)
+	{
+		return static_cast<TWord>(value * lsbMask);
+	}
+
+	/** lane-wise wrap-around addition */
+	static constexpr TWord add(TWord a, TWord b)
+	{
+		const TWord sum = lowSum(a, b) ^ ((a ^ b) & msbMask);
+
+		return merge(a, sum);
+	}
+
+	/** lane-wise unsigned saturating addition */
+	static constexpr TWord addSaturated(TWord a, TWord b)
+	{
+		const TWord low = lowSum(a, b);
+		const TWord sum = low ^ ((a ^ b) & msbMask);
+		const TWord overflow = static_cast<TWord>(((a & b) | ((a | b) & low)) & msbMask);
+
+		return merge(a, static_cast<TWord>(sum | spread(overflow)));
+	}
+
+	static constexpr TWord increment(TWord a)
+	{
+		return add(a, lsbMask);
+	}
+
+	static constexpr TWord incrementSaturated(TWord a)
+	{
+		return addSaturated(a, lsbMask);
+	}
+
+	/** lane-wise comparison, all bits of equal fields are set in the result */
+	static constexpr TWord equal(TWord a, TWord b)
+	{
+		const TWord diff = static_cast<TWord>((a ^ b) & fieldsMask);
+		const TWord nonZero = static_cast<TWord>((((diff & ~msbMask) + lowMask) | diff) & msbMask);
+
+		return spread(static_cast<TWord>(~nonZero & msbMask));
+	}
+
+private:
+	static constexpr TWord msbMask = Util::fieldMsbMask(TWordIdx);
+	static constexpr TWord lsbMask = Util::fieldLsbMask(TWordIdx);
+	static constexpr TWord lowMask = static_cast<TWord>(fieldsMask & ~msbMask);
+
+	/** sum of fields without most significant bits, carries end up in most significant bits */
+	static constexpr TWord lowSum(TWord a, TWord b)
+	{
+		return static_cast<TWord>((a & lowMask) + (b & lowMask));
+	}
+
+	static constexpr TWord merge(TWord a, TWord lanes)
+	{
+		return static_cast<TWord>((a & ~fieldsMask) | (lanes & fieldsMask));
+	}
+
+	/** expand flags located in most significant bits of fields to whole fields */
+	static constexpr TWord spread(TWord msbFlags)
+	{
+		return static_cast<TWord>((msbFlags - lsbFlags(msbFlags)) | msbFlags);
+	}
+
+	/** move flags from most significant to least significant bits of fields */
+	static constexpr TWord lsbFlags(TWord msbFlags)
+	{
+		constexpr size_t width = Util::uniformFieldWidth(TWordIdx);
+
+		if constexpr (width != 0) {
+			return static_cast<TWord>(msbFlags >> (width - 1));
+		} else {
+			TWord flags = 0;
+
+			for (auto const &entry : TBitFieldDef::layout) {
+				if (entry.word == TWordIdx) {
+					flags |= static_cast<TWord>((msbFlags & bit<TWord>(entry.msb)) >> (entry.msb - entry.lsb));
+				}
+			}
+
+			return flags;
+		}
+	}
+
+	static_assert(!Util::hasOverlappingFieldsInWord(TWordIdx), "SWAR lanes are overlapping");
+};
+
+/**
+ * Mutable bit field word accessor
+ *
+ * Caches the word on construction, accumulates chained set() calls in the cached copy
+ * and writes the word back once on commit() or on destruction
+ *
+ * @tparam TStorage bit field set storage type, could be volatile qualified
+ */
+template <typename TBitFieldDef, size_t TWordIdx, typename TStorage>
+class BitFieldWordImpl {
+	using TWord = typename TBitFieldDef::WordType;
+
+public:
+	constexpr BitFieldWordImpl(TStorage &storage, TWord initial, bool modified) noexcept
+		: rawStorage(storage), cachedWord(initial), pending(modified)
+	{
+	}
+
+	BitFieldWordImpl(const BitFieldWordImpl&) = delete;
+	BitFieldWordImpl& operator=(const BitFieldWordImpl&) = delete;
+
+	constexpr ~BitFieldWordImpl()
+	{
+		if (pending) {
+			commit();
+		}
+	}
+
+	template <typename TBitFieldDef::FIELDS field>
+	constexpr BitFieldWordImpl &set(TWord value) noexcept
+	{
+		static_assert(TBitFieldDef::layout[field].word == TWordIdx,
+					  "cascading field accessors from different words");
+
+		const auto &entry = TBitFieldDef::layout[field];
+		const TWord mask = bitMask<TWord>(entry.lsb, entry.msb);
+
+		static_assert(entry.access != AccessType::READ_ONLY, "writing to RO field");
+
+		cachedWord = static_cast<TWord>((cachedWord & ~mask) | ((value << entry.lsb) & mask));
+		pending = true;
+
+		return *this;
+	}
+
+	template <typename TBitFieldDef::FIELDS field>
+	constexpr TWord get() const noexcept
+	{
+		static_assert(TBitFieldDef::layout[field].word == TWordIdx,
+					  "cascading field accessors from different words");
+
+		const auto &entry = TBitFieldDef::layout[field];
+		const TWord mask = bitMask<TWord>(entry.lsb, entry.msb);
+
+		static_assert(entry.access != AccessType::WRITE_ONLY, "reading from WO field");
+
+		return static_cast<TWord>((cachedWord & mask) >> entry.lsb);
+	}
+
+	/** write cached word back with a single store */
+	constexpr void commit() noexcept
+	{
+		rawStorage.template store<TWordIdx>(BitFieldSetUtil<TBitFieldDef>::toMemory(cachedWord));
+		pending = false;
+	}
+
+	/** drop pending modifications, nothing is written back */
+	constexpr void discard() noexcept
+	{
+		pending = false;
+	}
+
+private:
+	TStorage &rawStorage;
+	TWord cachedWord;
+	bool pending;
+};
+
+/**
+ * Bit field set
+ *
+ * @tparam TBitFieldDef bit field set layout definition
+ * @tparam TStorage storage policy, see BitFieldStorage
+ */
+template <typename TBitFieldDef, typename TStorage>
+class BitFieldSet : public TBitFieldDef {
+public:
+	using TWord = typename TBitFieldDef::WordType;
+	using Layout = TBitFieldDef;
+	using Storage = TStorage;
+
+	/** value type of a single field in multi-field accessors */
+	template <typename TBitFieldDef::FIELDS>
+	using FieldValue = TWord;
+
+	template <typename TBitFieldDef::FIELDS field>
+	constexpr auto word() const
+	{
+		return BitFieldWordConst<field>(loadWord<wordIdx(field)>(raw));
+	}
+
+	template <typename TBitFieldDef::FIELDS field>
+	constexpr auto word() const volatile
+	{
+		return BitFieldWordConst<field>(loadWord<wordIdx(field)>(raw));
+	}
+
+	template <typename TBitFieldDef::FIELDS field>
+	consteval auto constWord() const
+	{
+		return word<field>();
+	}
+
+	template <typename TBitFieldDef::FIELDS field>
+	consteval auto constWord() const volatile
+	{
+		return word<field>();
+	}
+
+	/**
+	 * Get mutable accessor to the word containing #field
+	 *
+	 * Depending on #init the word is read once or not read at all, chained set() calls
+	 * update cached value which is written back with a single store
+	 */
+	template <typename TBitFieldDef::FIELDS field, WordInit init = WordInit::READ>
+	constexpr auto modify()
+	{
+		return BitFieldWord<field, TStorage>(raw, initialWord<wordIdx(field), init>(raw),
+											 init != WordInit::READ);
+	}
+
+	template <typename TBitFieldDef::FIELDS field, WordInit init = WordInit::READ>
+	constexpr auto modify() volatile
+	{
+		return BitFieldWord<field, volatile TStorage>(raw, initialWord<wordIdx(field), init>(raw),
+													  init != WordInit::READ);
+	}
+
+	/**
+	 * Set bit field value
+	 *
+	 * Field covering all defined bits of its word is written with a plain store,
+	 * otherwise the word is updated with a single read-modify-write sequence
+	 */
+	template <typename TBitFieldDef::FIELDS field>
+	constexpr void set(TWord value)
+	{
+		setBatch<field>(raw, value);
+	}
+
+	template <typename TBitFieldDef::FIELDS field>
+	constexpr void set(TWord value) volatile
+	{
+		setBatch<field>(raw, value);
+	}
+
+	/**
+	 * Set several bit fields at once
+	 *
+	 * Fields are grouped by word at compile time, so every touched word is updated
+	 * with exactly one load and one store regardless of the number of fields in it.
+	 * Words whose defined bits are all covered by the batch are stored without a read.
+	 * Values are passed in the same order as fields
+	 */
+	template <typename TBitFieldDef::FIELDS... fields>
+		requires (sizeof...(fields) > 1)
+	constexpr void set(FieldValue<fields>... values)
+	{
+		setBatch<fields...>(raw, values...);
+	}
+
+	template <typename TBitFieldDef::FIELDS... fields>
+		requires (sizeof...(fields) > 1)
+	constexpr void set(FieldValue<fields>... values) volatile
+	{
+		setBatch<fields...>(raw, values...);
+	}
+
+	template <typename TBitFieldDef::FIELDS field>
+	constexpr TWord get() const
+	{
+		const auto &entry = TBitFieldDef::layout[field];
+		const TWord mask = bitMask<TWord>(entry.lsb, entry.msb);
+		const TWord word = loadWord<wordIdx(field)>(raw);
+
+		static_assert(entry.access != AccessType::WRITE_ONLY, "reading from WO field");
+
+		return static_cast<TWord>((word & mask) >> entry.lsb);
+	}
+
+	template <typename TBitFieldDef::FIELDS field>
+	constexpr TWord get() const volatile
+	{
+		const auto &entry = TBitFieldDef::layout[field];
+		const TWord mask = bitMask<TWord>(entry.lsb, entry.msb);
+		const TWord word = loadWord<wordIdx(field)>(raw);
+
+		static_assert(entry.access != AccessType::WRITE_ONLY, "reading from WO field");
+
+		return static_cast<TWord>((word & mask) >> entry.lsb);
+	}
+
+	/**
+	 * Compare bit field with #value
+	 *
+	 * Comparison is done on the word in memory byte order with field mask and value
+	 * converted to it, so with constant #value no byte swap is performed at runtime
+	 */
+	template <typename TBitFieldDef::FIELDS field>
+	constexpr bool equals(TWord value) const
+	{
+		return equalsWord<field>(raw, value);
+	}
+
+	template <typename TBitFieldDef::FIELDS field>
+	constexpr bool equals(TWord value) const volatile
+	{
+		return equalsWord<field>(raw, value);
+	}
+
+	/**
+	 * Get values of several bit fields at once
+	 *
+	 * Every word involved is read exactly once, values are returned in the same order
+	 * as fields. With CONFIG_BITFIELDSET_BMI2 defined (and -mbmi2) fields of a word are
+	 * extracted with a single pext using the combined field mask of the word
+	 */
+	template <typename TBitFieldDef::FIELDS... fields>
+	constexpr std::array<TWord, sizeof...(fields)> unpack() const
+	{
+		return unpackBatch<fields...>(raw);
+	}
+
+	template <typename TBitFieldDef::FIELDS... fields>
+	constexpr std::array<TWord, sizeof...(fields)> unpack() const volatile
+	{
+		return unpackBatch<fields...>(raw);
+	}
+
+	/**
+	 * Set several bit fields from array of values, counterpart of unpack()
+	 *
+	 * Words are updated as in multi-field set(), with CONFIG_BITFIELDSET_BMI2 defined fields
+	 * of a word are deposited with a single pdep
+	 */
+	template <typename TBitFieldDef::FIELDS... fields>
+	constexpr void pack(const std::array<TWord, sizeof...(fields)> &values)
+	{
+		packBatch<fields...>(raw, values);
+	}
+
+	template <typename TBitFieldDef::FIELDS... fields>
+	constexpr void pack(const std::array<TWord, sizeof...(fields)> &values) volatile
+	{
+		packBatch<fields...>(raw, values);
+	}
+
+	/**
+	 * Get bit field value by runtime field index
+	 *
+	 * Field is looked up in a constant {word, shift, mask} table. With default storage policy
+	 * the word is indexed directly and the lookup is branch-free, other policies (volatile,
+	 * atomic, etc) load the word through a per-word accessor table.
+	 * Reading out of range or WO field returns 0
+	 */
+	TWord get(typename TBitFieldDef::FIELDS field) const
+	{
+		return getIndexed(raw, field);
+	}
+
+	TWord get(typename TBitFieldDef::FIELDS field) const volatile
+	{
+		return getIndexed(raw, field);
+	}
+
+	/**
+	 * Set bit field value by runtime field index
+	 *
+	 * Word is updated with a read-modify-write sequence (not atomic even with atomic storage).
+	 * Writing to out of range or RO field is ignored
+	 */
+	void set(typename TBitFieldDef::FIELDS field, TWord value)
+	{
+		setIndexed(raw, field, value);
+	}
+
+	void set(typename TBitFieldDef::FIELDS field, TWord value) volatile
+	{
+		setIndexed(raw, field, value);
+	}
+
+	/**
+	 * Compare and swap single field
+	 *
+	 * Field is set to #desired only if its current value equals #expected, otherwise
+	 * #expected is updated with the current field value. Atomic with atomic storage policy
+	 */
+	template <typename TBitFieldDef::FIELDS field>
+	constexpr bool compareExchange(TWord &expected, TWord desired)
+	{
+		return compareExchangeBatch<field>(raw, expected, desired);
+	}
+
+	template <typename TBitFieldDef::FIELDS field>
+	constexpr bool compareExchange(TWord &expected, TWord desired) volatile
+	{
+		return compareExchangeBatch<field>(raw, expected, desired);
+	}
+
+	/**
+	 * Multi-field state transition
+	 *
+	 * All #fields are set to #desired values only if every field matches its #expected value.
+	 * Fields should be located in the same word, the transition is done as a single
+	 * compare and swap on that word with masks folded at compile time
+	 */
+	template <typename TBitFieldDef::FIELDS... fields>
+	constexpr bool transition(const std::array<TWord, sizeof...(fields)> &expected,
+							  const std::array<TWord, sizeof...(fields)> &desired)
+	{
+		return transitionBatch<fields...>(raw, expected, desired);
+	}
+
+	template <typename TBitFieldDef::FIELDS... fields>
+	constexpr bool transition(const std::array<TWord, sizeof...(fields)> &expected,
+							  const std::array<TWord, sizeof...(fields)> &desired) volatile
+	{
+		return transitionBatch<fields...>(raw, expected, desired);
+	}
+
+	/** SWAR arithmetic over fields of the word containing #field */
+	template <typename TBitFieldDef::FIELDS field>
+	using Swar = BitFieldSwarImpl<TBitFieldDef, TBitFieldDef::layout[field].word>;
+
+	/**
+	 * Add packed #addend to all fields of the word containing #field
+	 *
+	 * Word is loaded and stored once, the update is not atomic even with atomic storage
+	 */
+	template <typename TBitFieldDef::FIELDS field, bool saturate = false>
+	constexpr void swarAdd(TWord addend)
+	{
+		swarAddWord<field, saturate>(raw, addend);
+	}
+
+	template <typename TBitFieldDef::FIELDS field, bool saturate = false>
+	constexpr void swarAdd(TWord addend) volatile
+	{
+		swarAddWord<field, saturate>(raw, addend);
+	}
+
+	/** increment all fields of the word containing #field */
+	template <typename TBitFieldDef::FIELDS field, bool saturate = false>
+	constexpr void swarIncrement()
+	{
+		swarAddWord<field, saturate>(raw, Swar<field>::splat(1));
+	}
+
+	template <typename TBitFieldDef::FIELDS field, bool saturate = false>
+	constexpr void swarIncrement() volatile
+	{
+		swarAddWord<field, saturate>(raw, Swar<field>::splat(1));
+	}
+
+	/** compare all fields of the word containing #field with packed #other, see BitFieldSwarImpl::equal() */
+	template <typename TBitFieldDef::FIELDS field>
+	constexpr TWord swarEqual(TWord other) const
+	{
+		return Swar<field>::equal(loadWord<wordIdx(field)>(raw), other);
+	}
+
+	template <typename TBitFieldDef::FIELDS field>
+	constexpr TWord swarEqual(TWord other) const volatile
+	{
+		return Swar<field>::equal(loadWord<wordIdx(field)>(raw), other);
+	}
+
+	/**
+	 * Get compound value assembled from several fields
+	 *
+	 * Each field is placed into the value at its BitField::compoundOffset,
+	 * every word involved is read exactly once
+	 */
+	template <typename TBitFieldDef::FIELDS... fields>
+	constexpr uint64_t getCompound() const
+	{
+		return getCompoundBatch<fields...>(raw);
+	}
+
+	template <typename TBitFieldDef::FIELDS... fields>
+	constexpr uint64_t getCompound() const volatile
+	{
+		return getCompoundBatch<fields...>(raw);
+	}
+
+	/**
+	 * Scatter compound value into several fields
+	 *
+	 * Each field receives value bits starting at its BitField::compoundOffset,
+	 * every word involved is updated as in multi-field set()
+	 */
+	template <typename TBitFieldDef::FIELDS... fields>
+	constexpr void setCompound(uint64_t value)
+	{
+		static_assert(FieldBatch<fields...>::isCompoundConsistent(), "Compound value parts are inconsistent");
+
+		setBatch<fields...>(raw, compoundPart<fields>(value)...);
+	}
+
+	template <typename TBitFieldDef::FIELDS... fields>
+	constexpr void setCompound(uint64_t value) volatile
+	{
+		static_assert(FieldBatch<fields...>::isCompoundConsistent(), "Compound value parts are inconsistent");
+
+		setBatch<fields...>(raw, compoundPart<fields>(value)...);
+	}
+
+	template <typename TBitFieldDef::FIELDS field>
+	constexpr auto get(TWord &value) const
+	{
+		auto w = word<field>();
+
+		w.template get<field>(value);
+
+		return w;
+	}
+
+	template <typename TBitFieldDef::FIELDS field>
+	constexpr auto get(TWord &value) const volatile
+	{
+		auto w = word<field>();
+
+		w.template get<field>(value);
+
+		return w;
+	}
+
+	/** true if all defined bits of the sets are equal, reserved bits are ignored */
+	template <typename TOtherStorage>
+	constexpr bool equalsDefined(const BitFieldSet<TBitFieldDef, TOtherStorage> &other) const
+	{
+		constexpr auto defined = Util::definedImage();
+
+		return [&]<size_t... I>(std::index_sequence<I...>) {
+			return (((raw.template load<I>() & defined[I]) ==
+					 (other.storage().template load<I>() & defined[I])) && ...);
+		}(std::make_index_sequence<TBitFieldDef::wordCount>{});
+	}
+
+	/**
+	 * Hash of defined bits, sets equal by equalsDefined() have equal hashes
+	 *
+	 * Words are mixed in one by one (multiply-xorshift), followed by 64-bit finalizer
+	 */
+	constexpr size_t hashDefined() const
+	{
+		constexpr auto defined = Util::definedImage();
+		uint64_t h = 0x9e3779b97f4a7c15ull;
+
+		[&]<size_t... I>(std::index_sequence<I...>) {
+			((h = (h ^ static_cast<uint64_t>(raw.template load<I>() & defined[I])) * 0xff51afd7ed558ccdull,
+			  h ^= h >> 32), ...);
+		}(std::make_index_sequence<TBitFieldDef::wordCount>{});
+
+		h ^= h >> 33;
+		h *= 0xc4ceb9fe1a85ec53ull;
+		h ^= h >> 33;
+
+		return static_cast<size_t>(h);
+	}
+
+	constexpr void resetAll()
+	{
+		fillWords(raw, 0);
+	}
+
+	constexpr void resetAll() volatile
+	{
+		fillWords(raw, 0);
+	}
+
+	/** set all fields to default values, straight run of word stores of the default image */
+	constexpr void resetToDefaults()
+	{
+		constexpr auto image = Util::defaultImage();
+
+		storeImage(raw, image);
+	}
+
+	constexpr void resetToDefaults() volatile
+	{
+		constexpr auto image = Util::defaultImage();
+
+		storeImage(raw, image);
+	}
+
+	/** underlying storage policy object */
+	constexpr TStorage &storage()
+	{
+		return raw;
+	}
+
+	constexpr const TStorage &storage() const
+	{
+		return raw;
+	}
+
+	constexpr volatile TStorage &storage() volatile
+	{
+		return raw;
+	}
+
+private:
+	using Util = BitFieldSetUtil<TBitFieldDef>;
+
+	static constexpr size_t wordIdx(typename TBitFieldDef::FIELDS field)
+	{
+		return TBitFieldDef::layout[static_cast<size_t>(field)].word;
+	}
+
+	static constexpr TWord fieldMask(typename TBitFieldDef::FIELDS field)
+	{
+		const auto &entry = TBitFieldDef::layout[static_cast<size_t>(field)];
+
+		return bitMask<TWord>(entry.lsb, entry.msb);
+	}
+
+	template <typename TBitFieldDef::FIELDS field>
+	using BitFieldWordConst = BitFieldWordConstImpl<TBitFieldDef, wordIdx(field)>;
+
+	template <typename TBitFieldDef::FIELDS field, typename TRaw>
+	using BitFieldWord = BitFieldWordImpl<TBitFieldDef, wordIdx(field), TRaw>;
+
+	/** word #TWordIdx loaded from storage and converted to native byte order */
+	template <size_t TWordIdx, typename TRaw>
+	static constexpr TWord loadWord(TRaw &words)
+	{
+		return Util::fromMemory(words.template load<TWordIdx>());
+	}
+
+	template <typename TBitFieldDef::FIELDS field, typename TRaw>
+	static constexpr bool equalsWord(TRaw &words, TWord value)
+	{
+		constexpr size_t idx = wordIdx(field);
+
+		static_assert(TBitFieldDef::layout[field].access != AccessType::WRITE_ONLY, "reading from WO field");
+
+		return (words.template load<idx>() & Util::toMemory(fieldMask(field))) ==
+			   Util::toMemory(wordBits<idx, field>(value));
+	}
+
+	template <size_t TWordIdx, WordInit init, typename TRaw>
+	static constexpr TWord initialWord(TRaw &words)
+	{
+		if constexpr (init == WordInit::READ) {
+			return loadWord<TWordIdx>(words);
+		} else if constexpr (init == WordInit::DEFAULT) {
+			return Util::defaultWord(TWordIdx);
+		} else {
+			return 0;
+		}
+	}
+
+	/** Compile time description of a multi-field access */
+	template <typename TBitFieldDef::FIELDS... fields>
+	struct FieldBatch {
+		static constexpr size_t count = sizeof...(fields);
+		static constexpr typename TBitFieldDef::FIELDS field[count] = { fields... };
+
+		/** true if field #i is the first one in the batch located in its word */
+		static constexpr bool isFirstInWord(size_t i)
+		{
+			for (size_t j = 0; j < i; j++) {
+				if (wordIdx(field[j]) == wordIdx(field[i])) {
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		/** combined mask of all batch fields located in word #idx */
+		static constexpr TWord wordMask(size_t idx)
+		{
+			TWord mask = 0;
+
+			for (size_t i = 0; i < count; i++) {
+				if (wordIdx(field[i]) == idx) {
+					mask |= fieldMask(field[i]);
+				}
+			}
+
+			return mask;
+		}
+
+		static constexpr bool isSingleWord()
+		{
+			for (size_t i = 0; i < count; i++) {
+				if (wordIdx(field[i]) != wordIdx(field[0])) {
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		static constexpr bool hasDuplicates()
+		{
+			for (size_t i = 0; i < count; i++) {
+				for (size_t j = i + 1; j < count; j++) {
+					if (field[i] == field[j]) {
+						return true;
+					}
+				}
+			}
+
+			return false;
+		}
+
+		/** compound value parts do not overlap and fit into 64-bit value */
+		static constexpr bool isCompoundConsistent()
+		{
+			uint64_t used = 0;
+
+			for (size_t i = 0; i < count; i++) {
+				const auto &entry = TBitFieldDef::layout[field[i]];
+				const size_t width = entry.msb - entry.lsb + 1;
+
+				if (entry.compoundOffset + width > std::numeric_limits<uint64_t>::digits) {
+					return false;
+				}
+
+				const uint64_t mask = bitMask<uint64_t>(entry.compoundOffset,
+														static_cast<uint8_t>(entry.compoundOffset + width - 1));
+
+				if ((used & mask) != 0) {
+					return false;
+				}
+
+				used |= mask;
+			}
+
+			return true;
+		}
+
+		static constexpr bool hasAccess(AccessType access)
+		{
+			for (size_t i = 0; i < count; i++) {
+				if (TBitFieldDef::layout[field[i]].access == access) {
+					return true;
+				}
+			}
+
+			return false;
+		}
+	};
+
+	template <typename TBitFieldDef::FIELDS... fields, typename TRaw>
+	static constexpr void setBatch(TRaw &words, FieldValue<fields>... values)
+	{
+		using Batch = FieldBatch<fields...>;
+		const TWord fieldValues[] = { values... };
+
+		static_assert(!Batch::hasDuplicates(), "same field is set twice in a batch");
+		static_assert(!Batch::hasAccess(AccessType::READ_ONLY), "writing to RO field");
+
+		[&]<size_t... I>(std::index_sequence<I...>) {
+			(setBatchWord<I, fields...>(words, fieldValues), ...);
+		}(std::make_index_sequence<Batch::count>{});
+	}
+
+	template <size_t TFirst, typename TBitFieldDef::FIELDS... fields, typename TRaw>
+	static constexpr void setBatchWord(TRaw &words, const TWord *values)
+	{
+		using Batch = FieldBatch<fields...>;
+
+		if constexpr (Batch::isFirstInWord(TFirst)) {
+			constexpr size_t idx = wordIdx(Batch::field[TFirst]);
+			constexpr TWord mask = Batch::wordMask(idx);
+
+			storeBits<idx, mask>(words, packBits<idx, fields...>(values));
+		}
+	}
+
+	/** store #bits covering #mask of word #TWordIdx, plain store if all defined bits are covered */
+	template <size_t TWordIdx, TWord mask, typename TRaw>
+	static constexpr void storeBits(TRaw &words, TWord bits)
+	{
+		if constexpr ((mask & Util::definedMask(TWordIdx)) == Util::definedMask(TWordIdx)) {
+			words.template store<TWordIdx>(Util::toMemory(bits));
+		} else {
+			words.template update<TWordIdx, Util::toMemory(mask)>(Util::toMemory(bits));
+		}
+	}
+
+	template <typename TBitFieldDef::FIELDS... fields, typename TRaw>
+	static constexpr std::array<TWord, sizeof...(fields)> unpackBatch(TRaw &words)
+	{
+		using Batch = FieldBatch<fields...>;
+		std::array<TWord, sizeof...(fields)> values = {};
+
+		static_assert(!Batch::hasAccess(AccessType::WRITE_ONLY), "reading from WO field");
+
+		[&]<size_t... I>(std::index_sequence<I...>) {
+			(unpackWord<I, fields...>(words, values), ...);
+		}(std::make_index_sequence<Batch::count>{});
+
+		return values;
+	}
+
+	template <size_t TFirst, typename TBitFieldDef::FIELDS... fields, typename TRaw>
+	static constexpr void unpackWord(TRaw &words, std::array<TWord, sizeof...(fields)> &values)
+	{
+		using Batch = FieldBatch<fields...>;
+
+		if constexpr (Batch::isFirstInWord(TFirst)) {
+			constexpr size_t idx = wordIdx(Batch::field[TFirst]);
+			const TWord word = loadWord<idx>(words);
+
+#if BITFIELDSET_BMI2
+			if (!std::is_constant_evaluated()) {
+				constexpr TWord mask = Batch::wordMask(idx);
+
+				unpackFields<idx, true, fields...>(extractBits(word, mask), values);
+				return;
+			}
+#endif
+
+			unpackFields<idx, false, fields...>(word, values);
+		}
+	}
+
+	template <typename TBitFieldDef::FIELDS... fields, typename TRaw>
+	static constexpr void packBatch(TRaw &words, const std::array<TWord, sizeof...(fields)> &values)
+	{
+		using Batch = FieldBatch<fields...>;
+
+		static_assert(!Batch::hasDuplicates(), "same field is set twice in a batch");
+		static_assert(!Batch::hasAccess(AccessType::READ_ONLY), "writing to RO field");
+
+		[&]<size_t... I>(std::index_sequence<I...>) {
+			(packWord<I, fields...>(words, values), ...);
+		}(std::make_index_sequence<Batch::count>{});
+	}
+
+	template <size_t TFirst, typename TBitFieldDef::FIELDS... fields, typename TRaw>
+	static constexpr void packWord(TRaw &words, const std::array<TWord, sizeof...(fields)> &values)
+	{
+		using Batch = FieldBatch<fields...>;
+
+		if constexpr (Batch::isFirstInWord(TFirst)) {
+			constexpr size_t idx = wordIdx(Batch::field[TFirst]);
+			constexpr TWord mask = Batch::wordMask(idx);
+
+#if BITFIELDSET_BMI2
+			if (!std::is_constant_evaluated()) {
+				storeBits<idx, mask>(words, depositBits(packFields<idx, true, fields...>(values), mask));
+				return;
+			}
+#endif
+
+			storeBits<idx, mask>(words, packFields<idx, false, fields...>(values));
+		}
+	}
+
+	/**
+	 * Values of batch fields located in word #TWordIdx taken from #bits
+	 *
+	 * #bits is either the word itself or the word with all batch fields extracted (pext) to
+	 * the low bits if #extracted is set
+	 */
+	template <size_t TWordIdx, bool extracted, typename TBitFieldDef::FIELDS... fields>
+	static constexpr void unpackFields(TWord bits, std::array<TWord, sizeof...(fields)> &values)
+	{
+		[&]<size_t... I>(std::index_sequence<I...>) {
+			(unpackField<TWordIdx, extracted, I, fields...>(bits, values), ...);
+		}(std::make_index_sequence<sizeof...(fields)>{});
+	}
+
+	template <size_t TWordIdx, bool extracted, size_t TIdx, typename TBitFieldDef::FIELDS... fields>
+	static constexpr void unpackField(TWord bits, std::array<TWord, sizeof...(fields)> &values)
+	{
+		constexpr auto field = FieldBatch<fields...>::field[TIdx];
+
+		if constexpr (wordIdx(field) == TWordIdx) {
+			constexpr uint8_t shift = batchShift<TWordIdx, extracted, fields...>(TIdx);
+			constexpr TWord max = fieldMask(field) >> TBitFieldDef::layout[field].lsb;
+
+			values[TIdx] = static_cast<TWord>((bits >> shift) & max);
+		}
+	}
+
+	/** counterpart of unpackFields(), values of batch fields combined into word or extracted form */
+	template <size_t TWordIdx, bool extracted, typename TBitFieldDef::FIELDS... fields>
+	static constexpr TWord packFields(const std::array<TWord, sizeof...(fields)> &values)
+	{
+		return [&]<size_t... I>(std::index_sequence<I...>) {
+			return static_cast<TWord>((packField<TWordIdx, extracted, I, fields...>(values[I]) | ...));
+		}(std::make_index_sequence<sizeof...(fields)>{});
+	}
+
+	template <size_t TWordIdx, bool extracted, size_t TIdx, typename TBitFieldDef::FIELDS... fields>
+	static constexpr TWord packField(TWord value)
+	{
+		constexpr auto field = FieldBatch<fields...>::field[TIdx];
+
+		if constexpr (wordIdx(field) == TWordIdx) {
+			constexpr uint8_t shift = batchShift<TWordIdx, extracted, fields...>(TIdx);
+			constexpr TWord max = fieldMask(field) >> TBitFieldDef::layout[field].lsb;
+
+			return static_cast<TWord>((value & max) << shift);
+		} else {
+			return 0;
+		}
+	}
+
+	/** position of batch field #i in word #TWordIdx, or in its extracted form if #extracted is set */
+	template <size_t TWordIdx, bool extracted, typename TBitFieldDef::FIELDS... fields>
+	static constexpr uint8_t batchShift(size_t i)
+	{
+		const uint8_t lsb = TBitFieldDef::layout[FieldBatch<fields...>::field[i]].lsb;
+
+		if constexpr (extracted) {
+			const TWord below = static_cast<TWord>(FieldBatch<fields...>::wordMask(TWordIdx) & (bit<TWord>(lsb) - 1));
+
+			return static_cast<uint8_t>(std::popcount(below));
+		} else {
+			return lsb;
+		}
+	}
+
+#if BITFIELDSET_BMI2
+	static TWord extractBits(TWord word, TWord mask)
+	{
+		if constexpr (sizeof(TWord) > sizeof(uint32_t)) {
+			return static_cast<TWord>(_pext_u64(word, mask));
+		} else {
+			return static_cast<TWord>(_pext_u32(word, mask));
+		}
+	}
+
+	static TWord depositBits(TWord bits, TWord mask)
+	{
+		if constexpr (sizeof(TWord) > sizeof(uint32_t)) {
+			return static_cast<TWord>(_pdep_u64(bits, mask));
+		} else {
+			return static_cast<TWord>(_pdep_u32(bits, mask));
+		}
+	}
+#endif
+
+	template <typename TBitFieldDef::FIELDS field, typename TRaw>
+	static constexpr bool compareExchangeBatch(TRaw &words, TWord &expected, TWord desired)
+	{
+		constexpr size_t idx = wordIdx(field);
+		const auto &entry = TBitFieldDef::layout[field];
+		TWord expectedBits = Util::toMemory(wordBits<idx, field>(expected));
+
+		static_assert(entry.access == AccessType::READ_WRITE, "compare and swap on RO/WO field");
+
+		if (words.template compareExchange<idx, Util::toMemory(fieldMask(field))>(
+				expectedBits, Util::toMemory(wordBits<idx, field>(desired)))) {
+			return true;
+		}
+
+		expected = static_cast<TWord>(Util::fromMemory(expectedBits) >> entry.lsb);
+
+		return false;
+	}
+
+	template <typename TBitFieldDef::FIELDS... fields, typename TRaw>
+	static constexpr bool transitionBatch(TRaw &words, const std::array<TWord, sizeof...(fields)> &expected,
+										  const std::array<TWord, sizeof...(fields)> &desired)
+	{
+		using Batch = FieldBatch<fields...>;
+		constexpr size_t idx = wordIdx(Batch::field[0]);
+		TWord expectedBits = Util::toMemory(packBits<idx, fields...>(expected.data()));
+
+		static_assert(Batch::isSingleWord(), "transition fields are located in different words");
+		static_assert(!Batch::hasDuplicates(), "same field is used twice in a transition");
+		static_assert(!Batch::hasAccess(AccessType::READ_ONLY) && !Batch::hasAccess(AccessType::WRITE_ONLY),
+					  "transition on RO/WO field");
+
+		return words.template compareExchange<idx, Util::toMemory(Batch::wordMask(idx))>(
+			expectedBits, Util::toMemory(packBits<idx, fields...>(desired.data())));
+	}
+
+	/** values of #fields located in word #TWordIdx shifted and masked into their positions */
+	template <size_t TWordIdx, typename TBitFieldDef::FIELDS... fields>
+	static constexpr TWord packBits(const TWord *values)
+	{
+		return [&]<size_t... I>(std::index_sequence<I...>) {
+			return static_cast<TWord>((wordBits<TWordIdx, fields>(values[I]) | ...));
+		}(std::make_index_sequence<sizeof...(fields)>{});
+	}
+
+	template <typename TBitFieldDef::FIELDS field, bool saturate, typename TRaw>
+	static constexpr void swarAddWord(TRaw &words, TWord addend)
+	{
+		constexpr size_t idx = wordIdx(field);
+		const TWord value = loadWord<idx>(words);
+
+		static_assert(Util::accessMask(idx, AccessType::READ_ONLY) == Swar<field>::fieldsMask &&
+					  Util::accessMask(idx, AccessType::WRITE_ONLY) == Swar<field>::fieldsMask,
+					  "SWAR arithmetic on RO/WO field");
+
+		if constexpr (saturate) {
+			words.template store<idx>(Util::toMemory(Swar<field>::addSaturated(value, addend)));
+		} else {
+			words.template store<idx>(Util::toMemory(Swar<field>::add(value, addend)));
+		}
+	}
+
+	template <typename TRaw>
+	static constexpr void fillWords(TRaw &words, TWord value)
+	{
+		[&]<size_t... I>(std::index_sequence<I...>) {
+			(words.template store<I>(Util::toMemory(value)), ...);
+		}(std::make_index_sequence<TBitFieldDef::wordCount>{});
+	}
+
+	template <typename TRaw>
+	static constexpr void storeImage(TRaw &words, const std::array<TWord, TBitFieldDef::wordCount> &image)
+	{
+		[&]<size_t... I>(std::index_sequence<I...>) {
+			(words.template store<I>(Util::toMemory(image[I])), ...);
+		}(std::make_index_sequence<TBitFieldDef::wordCount>{});
+	}
+
+	template <typename TBitFieldDef::FIELDS... fields, typename TRaw>
+	static constexpr uint64_t getCompoundBatch(TRaw &words)
+	{
+		using Batch = FieldBatch<fields...>;
+
+		static_assert(Batch::isCompoundConsistent(), "Compound value parts are inconsistent");
+		static_assert(!Batch::hasAccess(AccessType::WRITE_ONLY), "reading from WO field");
+
+		return [&]<size_t... I>(std::index_sequence<I...>) {
+			return (getCompoundWord<I, fields...>(words) | ...);
+		}(std::make_index_sequence<Batch::count>{});
+	}
+
+	template <size_t TFirst, typename TBitFieldDef::FIELDS... fields, typename TRaw>
+	static constexpr uint64_t getCompoundWord(TRaw &words)
+	{
+		using Batch = FieldBatch<fields...>;
+
+		if constexpr (Batch::isFirstInWord(TFirst)) {
+			constexpr size_t idx = wordIdx(Batch::field[TFirst]);
+			const TWord word = loadWord<idx>(words);
+
+			return (compoundBits<idx, fields>(word) | ...);
+		} else {
+			return 0;
+		}
+	}
+
+	/** field value of #word placed at its compound offset, zero if field is not in word #TWordIdx */
+	template <size_t TWordIdx, typename TBitFieldDef::FIELDS field>
+	static constexpr uint64_t compoundBits(TWord word)
+	{
+		if constexpr (wordIdx(field) == TWordIdx) {
+			const auto &entry = TBitFieldDef::layout[field];
+
+			return static_cast<uint64_t>((word & fieldMask(field)) >> entry.lsb) << entry.compoundOffset;
+		} else {
+			return 0;
+		}
+	}
+
+	/** part of compound #value stored in #field */
+	template <typename TBitFieldDef::FIELDS field>
+	static constexpr TWord compoundPart(uint64_t value)
+	{
+		const auto &entry = TBitFieldDef::layout[field];
+
+		return static_cast<TWord>((value >> entry.compoundOffset) & (fieldMask(field) >> entry.lsb));
+	}
+
+	/** value shifted and masked into its field position, zero if field is not in word #TWordIdx */
+	template <size_t TWordIdx, typename TBitFieldDef::FIELDS field>
+	static constexpr TWord wordBits(TWord value)
+	{
+		if constexpr (wordIdx(field) == TWordIdx) {
+			return static_cast<TWord>((value << TBitFieldDef::layout[field].lsb) & fieldMask(field));
+		} else {
+			return 0;
+		}
+	}
+
+	static constexpr auto fieldLocations = Util::fieldLocations();
+
+	/** field location with access folded into read/write masks */
+	struct IndexedLocation {
+		uint16_t	word;
+		uint8_t		shift;
+		TWord		readMask;
+		TWord		writeMask;
+	};
+
+	/** locations of all fields, entry #fieldCount has zero masks and handles out of range index */
+	static constexpr std::array<IndexedLocation, TBitFieldDef::fieldCount + 1> indexedLocationsGen()
+	{
+		std::array<IndexedLocation, TBitFieldDef::fieldCount + 1> table = {};
+
+		for (size_t i = 0; i < TBitFieldDef::fieldCount; i++) {
+			const auto &loc = fieldLocations[i];
+
+			table[i] = {
+				.word = loc.word,
+				.shift = loc.shift,
+				.readMask = loc.access == AccessType::WRITE_ONLY ? TWord{0} : loc.mask,
+				.writeMask = loc.access == AccessType::READ_ONLY ? TWord{0} : loc.mask,
+			};
+		}
+
+		return table;
+	}
+
+	static constexpr auto indexedLocations = indexedLocationsGen();
+
+	/** plain memory words (default storage policy) are indexed directly by runtime accessors */
+	template <typename TRaw>
+	static constexpr bool isPlainStorage = std::is_same_v<std::remove_const_t<TRaw>, BitFieldStorage<TBitFieldDef>>;
+
+	template <size_t TWordIdx, typename TRaw>
+	static TWord loadIndexed(TRaw &words)
+	{
+		return loadWord<TWordIdx>(words);
+	}
+
+	template <size_t TWordIdx, typename TRaw>
+	static void updateIndexed(TRaw &words, TWord mask, TWord bits)
+	{
+		const TWord word = static_cast<TWord>((loadWord<TWordIdx>(words) & ~mask) | bits);
+
+		words.template store<TWordIdx>(Util::toMemory(word));
+	}
+
+	template <typename TRaw, size_t... indices>
+	static constexpr auto loadFuncTableGen(std::index_sequence<indices...>)
+	{
+		return std::array<TWord (*)(TRaw &), sizeof...(indices)>
+				{&loadIndexed<indices, TRaw>...};
+	}
+
+	template <typename TRaw, size_t... indices>
+	static constexpr auto updateFuncTableGen(std::index_sequence<indices...>)
+	{
+		return std::array<void (*)(TRaw &, TWord, TWord), sizeof...(indices)>
+				{&updateIndexed<indices, TRaw>...};
+	}
+
+	template <typename TRaw>
+	static TWord getIndexed(TRaw &words, typename TBitFieldDef::FIELDS field)
+	{
+		if constexpr (isPlainStorage<TRaw>) {
+			return getIndexedDirect(words, static_cast<size_t>(field));
+		} else {
+			return getIndexedTable(words, static_cast<size_t>(field));
+		}
+	}
+
+	template <typename TRaw>
+	static void setIndexed(TRaw &words, typename TBitFieldDef::FIELDS field, TWord value)
+	{
+		if constexpr (isPlainStorage<TRaw>) {
+			setIndexedDirect(words, static_cast<size_t>(field), value);
+		} else {
+			setIndexedTable(words, static_cast<size_t>(field), value);
+		}
+	}
+
+	template <typename TRaw>
+	static TWord getIndexedDirect(TRaw &words, size_t idx)
+	{
+		const auto &loc = indexedLocations[std::min(idx, TBitFieldDef::fieldCount)];
+
+		return static_cast<TWord>((Util::fromMemory(words.words[loc.word]) & loc.readMask) >> loc.shift);
+	}
+
+	/** RO and out of range fields have zero write mask, the word is stored unchanged */
+	template <typename TRaw>
+	static void setIndexedDirect(TRaw &words, size_t idx, TWord value)
+	{
+		const auto &loc = indexedLocations[std::min(idx, TBitFieldDef::fieldCount)];
+		TWord &word = words.words[loc.word];
+		const TWord bits = static_cast<TWord>((value << loc.shift) & loc.writeMask);
+
+		word = Util::toMemory(static_cast<TWord>((Util::fromMemory(word) & ~loc.writeMask) | bits));
+	}
+
+	template <typename TRaw>
+	static TWord getIndexedTable(TRaw &words, size_t idx)
+	{
+		using word_idx_seq = std::make_index_sequence<TBitFieldDef::wordCount>;
+		static constexpr auto func_tbl = loadFuncTableGen<TRaw>(word_idx_seq{});
+
+		if (idx >= TBitFieldDef::fieldCount || fieldLocations[idx].access == AccessType::WRITE_ONLY) {
+			return 0;
+		}
+
+		const auto &loc = fieldLocations[idx];
+
+		return static_cast<TWord>((func_tbl[loc.word](words) & loc.mask) >> loc.shift);
+	}
+
+	template <typename TRaw>
+	static void setIndexedTable(TRaw &words, size_t idx, TWord value)
+	{
+		using word_idx_seq = std::make_index_sequence<TBitFieldDef::wordCount>;
+		static constexpr auto func_tbl = updateFuncTableGen<TRaw>(word_idx_seq{});
+
+		if (idx >= TBitFieldDef::fieldCount || fieldLocations[idx].access == AccessType::READ_ONLY) {
+			return;
+		}
+
+		const auto &loc = fieldLocations[idx];
+
+		func_tbl[loc.word](words, loc.mask, static_cast<TWord>((value << loc.shift) & loc.mask));
+	}
+
+	/* Compile-time consistency checks */
+	static_assert(Util::isWordIdxWithinBounds(), "Word index is not within defined range");
+	static_assert(Util::isBitIndexWithinTypeBounds(), "Bit index is out of word type bounds");
+	static_assert(!Util::hasOverlappingFields(), "Bit fields are overlapping");
+	static_assert(Util::isByteOffsetConsistent(),
+				  "Byte offset value is not consistent with word value");
+	static_assert(Util::isDefaultValueConsistent(), "Default value is not consistent with bitmask");
+	static_assert(Util::isValueBoundsConsistent(), "Value bounds (min/max) are not consistent");
+
+	/* bit field underlying raw storage */
+	TStorage raw;
+};
+
+/**
+ * Hash of defined bits for unordered containers, see BitFieldSet::hashDefined()
+ *
+ * Unlike std::hash specialization accepts classes derived from BitFieldSet,
+ * use with BitFieldSetEqualDefined as key equality
+ */
+struct BitFieldSetHash {
+	template <typename TBitFieldDef, typename TStorage>
+	constexpr size_t operator()(const BitFieldSet<TBitFieldDef, TStorage> &s) const
+	{
+		return s.hashDefined();
+	}
+};
+
+/** Key equality matching BitFieldSetHash, reserved bits are ignored */
+struct BitFieldSetEqualDefined {
+	template <typename TBitFieldDef, typename TStorageA, typename TStorageB>
+	constexpr bool operator()(const BitFieldSet<TBitFieldDef, TStorageA> &a,
+							  const BitFieldSet<TBitFieldDef, TStorageB> &b) const
+	{
+		return a.equalsDefined(b);
+	}
 };
 
 }
 
+/**
+ * Hash of defined bits only, see hal::BitFieldSet::hashDefined()
+ *
+ * Matches BitFieldSet itself only, use hal::BitFieldSetHash for derived classes
+ */
+template <typename TBitFieldDef, typename TStorage>
+struct std::hash<hal::BitFieldSet<TBitFieldDef, TStorage>> {
+	constexpr size_t operator()(const hal::BitFieldSet<TBitFieldDef, TStorage> &s) const
+	{
+		return s.hashDefined();
+	}
+};
+
 #endif /* BITFIELDSET_BITFIELDSET_HPP */
@@ -0,0 +1,388 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Dmitrii Lebed <lebed.dmitry@gmail.com>
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+/**
+ * Batch bit field accessors over arrays of bit field sets
+ *
+ * Extracts a field from N bit field sets (e.g. HW descriptors in a ring) into a dense array
+ * and scatters a value or an array of values into a field of N bit field sets.
+ * Field masks and shifts are compile time constants. On x86-64 kernels using AVX2 gathers
+ * and AVX-512 gathers/scatters are selected at runtime, scalar loop is used otherwise
+ * (and for 8/16-bit words which have no gather instructions). Kernel could also be selected
+ * explicitly with BitFieldBatchKernel template parameter of the accessors.
+ * Define CONFIG_BITFIELDSET_BATCH_SCALAR to always use scalar implementation
+ */
+
+#ifndef BITFIELDSET_BITFIELDSET_BATCH_HPP
+#define BITFIELDSET_BITFIELDSET_BATCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#include "bitfieldset.hpp"
+
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(CONFIG_BITFIELDSET_BATCH_SCALAR)
+#define BITFIELDSET_BATCH_X86 1
+#include <immintrin.h>
+#else
+#define BITFIELDSET_BATCH_X86 0
+#endif
+
+namespace hal {
+
+/** Batch accessor kernel */
+enum class BitFieldBatchKernel {
+	/** widest kernel supported by the CPU, selected at runtime */
+	AUTO,
+	SCALAR,
+	/** AVX2 gathers, get() only, set() falls back to scalar loop */
+	AVX2,
+	/** AVX-512 gathers and scatters */
+	AVX512,
+};
+
+/**
+ * Batch accessors for arrays of bit field sets
+ *
+ * @tparam TSet BitFieldSet (or class derived from it) with default storage policy
+ */
+template <typename TSet>
+class BitFieldSetBatch {
+	using TBitFieldDef = typename TSet::Layout;
+	using TWord = typename TBitFieldDef::WordType;
+
+public:
+	/* Define class as a singleton */
+	BitFieldSetBatch() = default;
+	~BitFieldSetBatch() = default;
+	BitFieldSetBatch(const BitFieldSetBatch&) = delete;
+	BitFieldSetBatch& operator=(const BitFieldSetBatch&) = delete;
+
+	/**
+	 * Check whether #kernel could be used for TSet on this CPU
+	 *
+	 * Explicitly selected kernel is not checked by the accessors
+	 */
+	static bool supported(BitFieldBatchKernel kernel)
+	{
+		switch (kernel) {
+		case BitFieldBatchKernel::AUTO:
+		case BitFieldBatchKernel::SCALAR:
+			return true;
+#if BITFIELDSET_BATCH_X86
+		case BitFieldBatchKernel::AVX2:
+			return hasGather && __builtin_cpu_supports("avx2");
+		case BitFieldBatchKernel::AVX512:
+			return hasGather && __builtin_cpu_supports("avx512f");
+#endif
+		default:
+			return false;
+		}
+	}
+
+	/** out[i] = sets[i].get<field>() for i in [0, count) */
+	template <typename TBitFieldDef::FIELDS field, BitFieldBatchKernel kernel = BitFieldBatchKernel::AUTO>
+	static void get(const TSet *sets, size_t count, TWord *out)
+	{
+		static_assert(TBitFieldDef::layout[field].access != AccessType::WRITE_ONLY, "reading from WO field");
+
+#if BITFIELDSET_BATCH_X86
+		if constexpr (hasGather) {
+			/* vector kernels take the word address of sets[0] */
+			if (count == 0) {
+				return;
+			}
+
+			if (useKernel<kernel>(BitFieldBatchKernel::AVX512)) {
+				getAvx512<field>(sets, count, out);
+				return;
+			}
+
+			if (useKernel<kernel>(BitFieldBatchKernel::AVX2)) {
+				getAvx2<field>(sets, count, out);
+				return;
+			}
+		}
+#endif
+
+		getScalar<field>(sets, count, out, 0);
+	}
+
+	/** sets[i].set<field>(value) for i in [0, count) */
+	template <typename TBitFieldDef::FIELDS field, BitFieldBatchKernel kernel = BitFieldBatchKernel::AUTO>
+	static void set(TSet *sets, size_t count, TWord value)
+	{
+		static_assert(TBitFieldDef::layout[field].access != AccessType::READ_ONLY, "writing to RO field");
+
+#if BITFIELDSET_BATCH_X86
+		if constexpr (hasGather) {
+			/* vector kernels take the word address of sets[0] */
+			if (count == 0) {
+				return;
+			}
+
+			if (useKernel<kernel>(BitFieldBatchKernel::AVX512)) {
+				setAvx512<field, false>(sets, count, &value);
+				return;
+			}
+		}
+#endif
+
+		for (size_t i = 0; i < count; i++) {
+			sets[i].template set<field>(value);
+		}
+	}
+
+	/** sets[i].set<field>(values[i]) for i in [0, count) */
+	template <typename TBitFieldDef::FIELDS field, BitFieldBatchKernel kernel = BitFieldBatchKernel::AUTO>
+	static void set(TSet *sets, size_t count, const TWord *values)
+	{
+		static_assert(TBitFieldDef::layout[field].access != AccessType::READ_ONLY, "writing to RO field");
+
+#if BITFIELDSET_BATCH_X86
+		if constexpr (hasGather) {
+			/* vector kernels take the word address of sets[0] */
+			if (count == 0) {
+				return;
+			}
+
+			if (useKernel<kernel>(BitFieldBatchKernel::AVX512)) {
+				setAvx512<field, true>(sets, count, values);
+				return;
+			}
+		}
+#endif
+
+		setScalar<field>(sets, count, values, 0);
+	}
+
+private:
+	using Util = BitFieldSetUtil<TBitFieldDef>;
+
+	/* vector paths access words in native byte order only, other layouts use scalar loop */
+	static constexpr bool hasGather = (sizeof(TWord) == sizeof(uint32_t) || sizeof(TWord) == sizeof(uint64_t)) &&
+									  !Util::needsByteSwap();
+	static constexpr size_t stride = sizeof(TSet);
+
+	/** explicitly selected #kernel is used as is, AUTO is resolved with CPU feature check */
+	template <BitFieldBatchKernel kernel>
+	static bool useKernel(BitFieldBatchKernel isa)
+	{
+		if constexpr (kernel == BitFieldBatchKernel::AUTO) {
+			return supported(isa);
+		} else {
+			return kernel == isa;
+		}
+	}
+
+	template <typename TBitFieldDef::FIELDS field>
+	static constexpr TWord fieldMask()
+	{
+		const auto &entry = TBitFieldDef::layout[field];
+
+		return bitMask<TWord>(entry.lsb, entry.msb);
+	}
+
+	/** field mask covers all defined bits of its word, so the word is stored without a read */
+	template <typename TBitFieldDef::FIELDS field>
+	static constexpr bool isWholeWord()
+	{
+		constexpr TWord defined = Util::definedMask(TBitFieldDef::layout[field].word);
+
+		return (fieldMask<field>() & defined) == defined;
+	}
+
+	template <typename TBitFieldDef::FIELDS field>
+	static void getScalar(const TSet *sets, size_t count, TWord *out, size_t start)
+	{
+		for (size_t i = start; i < count; i++) {
+			out[i] = sets[i].template get<field>();
+		}
+	}
+
+	template <typename TBitFieldDef::FIELDS field>
+	static void setScalar(TSet *sets, size_t count, const TWord *values, size_t start)
+	{
+		for (size_t i = start; i < count; i++) {
+			sets[i].template set<field>(values[i]);
+		}
+	}
+
+#if BITFIELDSET_BATCH_X86
+	/** address of the word containing #field in the first set of the array */
+	template <typename TBitFieldDef::FIELDS field>
+	static const uint8_t *wordBase(const TSet *sets)
+	{
+		return reinterpret_cast<const uint8_t *>(&sets->storage().words[TBitFieldDef::layout[field].word]);
+	}
+
+	template <typename TBitFieldDef::FIELDS field>
+	static uint8_t *wordBase(TSet *sets)
+	{
+		return reinterpret_cast<uint8_t *>(&sets->storage().words[TBitFieldDef::layout[field].word]);
+	}
+
+	template <typename TBitFieldDef::FIELDS field>
+	__attribute__((target("avx2")))
+	static void getAvx2(const TSet *sets, size_t count, TWord *out)
+	{
+		constexpr uint8_t lsb = TBitFieldDef::layout[field].lsb;
+		constexpr int s = static_cast<int>(stride);
+		const uint8_t *base = wordBase<field>(sets);
+		size_t i = 0;
+
+		if constexpr (sizeof(TWord) == sizeof(uint32_t)) {
+			const __m256i index = _mm256_setr_epi32(0, s, 2 * s, 3 * s, 4 * s, 5 * s, 6 * s, 7 * s);
+			const __m256i mask = _mm256_set1_epi32(static_cast<int>(fieldMask<field>()));
+
+			for (; i + 8 <= count; i += 8) {
+				const auto *ptr = reinterpret_cast<const int *>(base + i * stride);
+				__m256i v = _mm256_i32gather_epi32(ptr, index, 1);
+
+				v = _mm256_srli_epi32(_mm256_and_si256(v, mask), lsb);
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), v);
+			}
+		} else {
+			const __m128i index = _mm_setr_epi32(0, s, 2 * s, 3 * s);
+			const __m256i mask = _mm256_set1_epi64x(static_cast<long long>(fieldMask<field>()));
+
+			for (; i + 4 <= count; i += 4) {
+				const auto *ptr = reinterpret_cast<const long long *>(base + i * stride);
+				__m256i v = _mm256_i32gather_epi64(ptr, index, 1);
+
+				v = _mm256_srli_epi64(_mm256_and_si256(v, mask), lsb);
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), v);
+			}
+		}
+
+		getScalar<field>(sets, count, out, i);
+	}
+
+	template <typename TBitFieldDef::FIELDS field>
+	__attribute__((target("avx512f")))
+	static void getAvx512(const TSet *sets, size_t count, TWord *out)
+	{
+		constexpr uint8_t lsb = TBitFieldDef::layout[field].lsb;
+		constexpr int s = static_cast<int>(stride);
+		const uint8_t *base = wordBase<field>(sets);
+		size_t i = 0;
+
+		if constexpr (sizeof(TWord) == sizeof(uint32_t)) {
+			const __m512i index = _mm512_setr_epi32(0, s, 2 * s, 3 * s, 4 * s, 5 * s, 6 * s, 7 * s,
+													8 * s, 9 * s, 10 * s, 11 * s, 12 * s, 13 * s, 14 * s, 15 * s);
+			const __m512i mask = _mm512_set1_epi32(static_cast<int>(fieldMask<field>()));
+			const __m512i zero = _mm512_setzero_si512();
+			const __mmask16 all = 0xffff;
+
+			for (; i + 16 <= count; i += 16) {
+				__m512i v = _mm512_mask_i32gather_epi32(zero, all, index, base + i * stride, 1);
+
+				v = _mm512_maskz_srli_epi32(all, _mm512_and_si512(v, mask), lsb);
+				_mm512_storeu_si512(out + i, v);
+			}
+		} else {
+			const __m256i index = _mm256_setr_epi32(0, s, 2 * s, 3 * s, 4 * s, 5 * s, 6 * s, 7 * s);
+			const __m512i mask = _mm512_set1_epi64(static_cast<long long>(fieldMask<field>()));
+			const __m512i zero = _mm512_setzero_si512();
+			const __mmask8 all = 0xff;
+
+			for (; i + 8 <= count; i += 8) {
+				__m512i v = _mm512_mask_i32gather_epi64(zero, all, index, base + i * stride, 1);
+
+				v = _mm512_maskz_srli_epi64(all, _mm512_and_si512(v, mask), lsb);
+				_mm512_storeu_si512(out + i, v);
+			}
+		}
+
+		getScalar<field>(sets, count, out, i);
+	}
+
+	/**
+	 * gather words, merge field bits and scatter words back, #values is an array or a single value
+	 * (array is not read when #count is 0, its pointer may be null)
+	 */
+	template <typename TBitFieldDef::FIELDS field, bool isArray>
+	__attribute__((target("avx512f")))
+	static void setAvx512(TSet *sets, size_t count, const TWord *values)
+	{
+		constexpr uint8_t lsb = TBitFieldDef::layout[field].lsb;
+		constexpr int s = static_cast<int>(stride);
+		uint8_t *base = wordBase<field>(sets);
+		size_t i = 0;
+
+		if constexpr (sizeof(TWord) == sizeof(uint32_t)) {
+			const __m512i index = _mm512_setr_epi32(0, s, 2 * s, 3 * s, 4 * s, 5 * s, 6 * s, 7 * s,
+													8 * s, 9 * s, 10 * s, 11 * s, 12 * s, 13 * s, 14 * s, 15 * s);
+			const __m512i mask = _mm512_set1_epi32(static_cast<int>(fieldMask<field>()));
+			const __m512i keep = _mm512_set1_epi32(static_cast<int>(static_cast<TWord>(~fieldMask<field>())));
+			const __m512i zero = _mm512_setzero_si512();
+			const __mmask16 all = 0xffff;
+			__m512i v = zero;
+
+			if constexpr (!isArray) {
+				v = _mm512_set1_epi32(static_cast<int>(values[0]));
+			}
+
+			for (; i + 16 <= count; i += 16) {
+				if constexpr (isArray) {
+					v = _mm512_loadu_si512(values + i);
+				}
+
+				__m512i bits = _mm512_and_si512(_mm512_maskz_slli_epi32(all, v, lsb), mask);
+
+				if constexpr (!isWholeWord<field>()) {
+					const __m512i w = _mm512_mask_i32gather_epi32(zero, all, index, base + i * stride, 1);
+
+					bits = _mm512_or_si512(_mm512_and_si512(w, keep), bits);
+				}
+
+				_mm512_i32scatter_epi32(base + i * stride, index, bits, 1);
+			}
+		} else {
+			const __m256i index = _mm256_setr_epi32(0, s, 2 * s, 3 * s, 4 * s, 5 * s, 6 * s, 7 * s);
+			const __m512i mask = _mm512_set1_epi64(static_cast<long long>(fieldMask<field>()));
+			const __m512i keep = _mm512_set1_epi64(static_cast<long long>(static_cast<TWord>(~fieldMask<field>())));
+			const __m512i zero = _mm512_setzero_si512();
+			const __mmask8 all = 0xff;
+			__m512i v = zero;
+
+			if constexpr (!isArray) {
+				v = _mm512_set1_epi64(static_cast<long long>(values[0]));
+			}
+
+			for (; i + 8 <= count; i += 8) {
+				if constexpr (isArray) {
+					v = _mm512_loadu_si512(values + i);
+				}
+
+				__m512i bits = _mm512_and_si512(_mm512_maskz_slli_epi64(all, v, lsb), mask);
+
+				if constexpr (!isWholeWord<field>()) {
+					const __m512i w = _mm512_mask_i32gather_epi64(zero, all, index, base + i * stride, 1);
+
+					bits = _mm512_or_si512(_mm512_and_si512(w, keep), bits);
+				}
+
+				_mm512_i32scatter_epi64(base + i * stride, index, bits, 1);
+			}
+		}
+
+		for (; i < count; i++) {
+			sets[i].template set<field>(isArray ? values[i] : values[0]);
+		}
+	}
+#endif
+
+	static_assert(std::is_same_v<typename TSet::Storage, BitFieldStorage<TBitFieldDef>>,
+				  "Batch accessors require default storage policy");
+	static_assert(stride * 15 <= static_cast<size_t>(std::numeric_limits<int32_t>::max()),
+				  "Bit field set is too large for 32-bit gather offsets");
+};
+
+}
+
+#endif /* BITFIELDSET_BITFIELDSET_BATCH_HPP */
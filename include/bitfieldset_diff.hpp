@@ -0,0 +1,251 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Dmitrii Lebed <lebed.dmitry@gmail.com>
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+/**
+ * Field-wise difference of two bit field sets
+ *
+ * Words of both sets are XORed and changed bits are mapped to fields with
+ * a compile time bit-to-field table, so the cost depends on the number of changed
+ * fields rather than on the number of fields in the layout
+ */
+
+#ifndef BITFIELDSET_BITFIELDSET_DIFF_HPP
+#define BITFIELDSET_BITFIELDSET_DIFF_HPP
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+
+#include "bitfieldset.hpp"
+
+namespace hal {
+
+/** Set of changed fields, returned by diff() */
+template <typename TBitFieldDef>
+class BitFieldDiff {
+	static constexpr size_t chunkBits = std::numeric_limits<uint64_t>::digits;
+	static constexpr size_t chunkCount = (TBitFieldDef::fieldCount + chunkBits - 1) / chunkBits;
+
+public:
+	using FIELDS = typename TBitFieldDef::FIELDS;
+
+	/** forward iterator over changed fields in ascending order */
+	class iterator {
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = FIELDS;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const FIELDS *;
+		using reference = FIELDS;
+
+		constexpr iterator() = default;
+
+		constexpr iterator(const std::array<uint64_t, chunkCount> *bits, size_t chunk)
+			: changed(bits), chunkIdx(chunk), pending(chunk < chunkCount ? (*bits)[chunk] : 0)
+		{
+			skipEmpty();
+		}
+
+		constexpr FIELDS operator*() const
+		{
+			return static_cast<FIELDS>(chunkIdx * chunkBits + static_cast<size_t>(std::countr_zero(pending)));
+		}
+
+		constexpr iterator &operator++()
+		{
+			pending &= pending - 1;
+			skipEmpty();
+
+			return *this;
+		}
+
+		constexpr iterator operator++(int)
+		{
+			iterator prev = *this;
+
+			++*this;
+
+			return prev;
+		}
+
+		constexpr bool operator==(const iterator &other) const
+		{
+			return chunkIdx == other.chunkIdx && pending == other.pending;
+		}
+
+	private:
+		constexpr void skipEmpty()
+		{
+			while (pending == 0 && chunkIdx < chunkCount) {
+				if (++chunkIdx < chunkCount) {
+					pending = (*changed)[chunkIdx];
+				}
+			}
+		}
+
+		const std::array<uint64_t, chunkCount> *changed = nullptr;
+		size_t chunkIdx = chunkCount;
+		uint64_t pending = 0;
+	};
+
+	constexpr bool test(FIELDS field) const
+	{
+		const size_t idx = static_cast<size_t>(field);
+
+		return (changed[idx / chunkBits] & bit<uint64_t>(idx % chunkBits)) != 0;
+	}
+
+	constexpr bool any() const
+	{
+		for (const uint64_t chunk : changed) {
+			if (chunk != 0) {
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	constexpr size_t count() const
+	{
+		size_t n = 0;
+
+		for (const uint64_t chunk : changed) {
+			n += static_cast<size_t>(std::popcount(chunk));
+		}
+
+		return n;
+	}
+
+	/** changed field bitmask, bit #i of the mask corresponds to field #i */
+	constexpr const std::array<uint64_t, chunkCount> &bits() const
+	{
+		return changed;
+	}
+
+	constexpr iterator begin() const
+	{
+		return iterator(&changed, 0);
+	}
+
+	constexpr iterator end() const
+	{
+		return iterator(&changed, chunkCount);
+	}
+
+	constexpr void mark(size_t idx)
+	{
+		changed[idx / chunkBits] |= bit<uint64_t>(idx % chunkBits);
+	}
+
+private:
+	std::array<uint64_t, chunkCount> changed = {};
+};
+
+namespace helpers {
+
+template <typename TBitFieldDef>
+struct BitFieldDiffImpl {
+	using TWord = typename TBitFieldDef::WordType;
+	using Util = BitFieldSetUtil<TBitFieldDef>;
+
+	static constexpr size_t wordBits = std::numeric_limits<TWord>::digits;
+
+	/** field containing bit #bitIdx of word #idx, first one for overlapping fields */
+	static constexpr uint16_t fieldOfBit(size_t idx, size_t bitIdx)
+	{
+		for (size_t i = 0; i < TBitFieldDef::fieldCount; i++) {
+			const auto &entry = TBitFieldDef::layout[i];
+
+			if (entry.word == idx && bitIdx >= entry.lsb && bitIdx <= entry.msb) {
+				return static_cast<uint16_t>(i);
+			}
+		}
+
+		return static_cast<uint16_t>(TBitFieldDef::fieldCount);
+	}
+
+	template <size_t TWordIdx>
+	static constexpr std::array<uint16_t, wordBits> bitToFieldTable()
+	{
+		std::array<uint16_t, wordBits> table = {};
+
+		for (size_t i = 0; i < wordBits; i++) {
+			table[i] = fieldOfBit(TWordIdx, i);
+		}
+
+		return table;
+	}
+
+	template <size_t TWordIdx>
+	static constexpr auto bitToField = bitToFieldTable<TWordIdx>();
+
+	static constexpr TWord fieldMask(size_t field)
+	{
+		return bitMask<TWord>(TBitFieldDef::layout[field].lsb, TBitFieldDef::layout[field].msb);
+	}
+
+	/** mark fields covering set bits of #changedBits (native byte order) of word #TWordIdx */
+	template <size_t TWordIdx>
+	static constexpr void markWord(BitFieldDiff<TBitFieldDef> &result, TWord changedBits)
+	{
+		TWord pending = static_cast<TWord>(changedBits & Util::definedMask(TWordIdx));
+
+		if constexpr (!Util::hasOverlappingFieldsInWord(TWordIdx)) {
+			/* one iteration per changed field, all bits of the field are dropped at once */
+			while (pending != 0) {
+				const uint16_t field = bitToField<TWordIdx>[static_cast<size_t>(std::countr_zero(pending))];
+
+				result.mark(field);
+				pending = static_cast<TWord>(pending & ~fieldMask(field));
+			}
+		} else {
+			if (pending != 0) {
+				for (size_t i = 0; i < TBitFieldDef::fieldCount; i++) {
+					if (TBitFieldDef::layout[i].word == TWordIdx && (pending & fieldMask(i)) != 0) {
+						result.mark(i);
+					}
+				}
+			}
+		}
+	}
+};
+
+}
+
+/**
+ * Fields which values differ between #a and #b
+ *
+ * Reserved (undefined) bits are ignored, WO fields are compared as stored
+ */
+template <typename TBitFieldDef, typename TStorageA, typename TStorageB>
+constexpr BitFieldDiff<TBitFieldDef> diff(const BitFieldSet<TBitFieldDef, TStorageA> &a,
+										  const BitFieldSet<TBitFieldDef, TStorageB> &b)
+{
+	using Impl = helpers::BitFieldDiffImpl<TBitFieldDef>;
+	using Util = typename Impl::Util;
+	using TWord = typename Impl::TWord;
+
+	std::array<TWord, TBitFieldDef::wordCount> changed;
+	BitFieldDiff<TBitFieldDef> result;
+
+	/* independent word XORs, vectorized by the compiler for large sets */
+	[&]<size_t... I>(std::index_sequence<I...>) {
+		((changed[I] = static_cast<TWord>(a.storage().template load<I>() ^ b.storage().template load<I>())), ...);
+	}(std::make_index_sequence<TBitFieldDef::wordCount>{});
+
+	[&]<size_t... I>(std::index_sequence<I...>) {
+		(Impl::template markWord<I>(result, Util::fromMemory(changed[I])), ...);
+	}(std::make_index_sequence<TBitFieldDef::wordCount>{});
+
+	return result;
+}
+
+}
+
+#endif /* BITFIELDSET_BITFIELDSET_DIFF_HPP */
@@ -0,0 +1,209 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Dmitrii Lebed <lebed.dmitry@gmail.com>
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+/**
+ * Structure-of-arrays container for large bit field set collections
+ *
+ * Every layout word is kept in its own contiguous column, so scanning a single field
+ * touches only the column of its word. Elements are accessed through proxies providing
+ * the same get/set API as BitFieldSet, collection could be converted to and from
+ * packed array of BitFieldSet
+ */
+
+#ifndef BITFIELDSET_BITFIELDSET_SOA_HPP
+#define BITFIELDSET_BITFIELDSET_SOA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "bitfieldset.hpp"
+
+namespace hal {
+
+/**
+ * Storage policy of a single element of BitFieldSetSoA
+ *
+ * Word #i of the element is located at #index in column #i
+ */
+template <typename TBitFieldDef>
+class BitFieldStorageSoA {
+public:
+	using TWord = typename TBitFieldDef::WordType;
+
+	constexpr void attach(std::vector<TWord> *cols, size_t idx)
+	{
+		columns = cols;
+		index = idx;
+	}
+
+	template <size_t TWordIdx>
+	constexpr TWord load() const
+	{
+		return columns[TWordIdx][index];
+	}
+
+	template <size_t TWordIdx>
+	constexpr void store(TWord value)
+	{
+		columns[TWordIdx][index] = value;
+	}
+
+	template <size_t TWordIdx, TWord mask>
+	constexpr void update(TWord bits)
+	{
+		TWord &word = columns[TWordIdx][index];
+
+		word = static_cast<TWord>((word & ~mask) | bits);
+	}
+
+	template <size_t TWordIdx, TWord mask>
+	constexpr bool compareExchange(TWord &expected, TWord desired)
+	{
+		TWord &word = columns[TWordIdx][index];
+
+		if ((word & mask) != expected) {
+			expected = word & mask;
+			return false;
+		}
+
+		word = static_cast<TWord>((word & ~mask) | desired);
+
+		return true;
+	}
+
+private:
+	std::vector<TWord> *columns;
+	size_t index;
+};
+
+/**
+ * Read-only storage policy of a single element of const BitFieldSetSoA
+ *
+ * Provides load() only, so modifying accessors of the element do not compile
+ */
+template <typename TBitFieldDef>
+class BitFieldStorageSoAConst {
+public:
+	using TWord = typename TBitFieldDef::WordType;
+
+	constexpr void attach(const std::vector<TWord> *cols, size_t idx)
+	{
+		columns = cols;
+		index = idx;
+	}
+
+	template <size_t TWordIdx>
+	constexpr TWord load() const
+	{
+		return columns[TWordIdx][index];
+	}
+
+private:
+	const std::vector<TWord> *columns;
+	size_t index;
+};
+
+template <typename TBitFieldDef>
+class BitFieldSetSoA {
+public:
+	using TWord = typename TBitFieldDef::WordType;
+	/** packed bit field set type */
+	using Packed = BitFieldSet<TBitFieldDef>;
+	/** element proxy type, provides BitFieldSet API */
+	using Element = BitFieldSet<TBitFieldDef, BitFieldStorageSoA<TBitFieldDef>>;
+	/** read-only element proxy type, provides BitFieldSet read API */
+	using ConstElement = BitFieldSet<TBitFieldDef, BitFieldStorageSoAConst<TBitFieldDef>>;
+
+	BitFieldSetSoA() = default;
+
+	explicit BitFieldSetSoA(size_t count)
+	{
+		resize(count);
+	}
+
+	size_t size() const
+	{
+		return columns[0].size();
+	}
+
+	void resize(size_t count)
+	{
+		for (auto &column : columns) {
+			column.resize(count);
+		}
+	}
+
+	Element operator[](size_t idx)
+	{
+		Element e;
+
+		e.storage().attach(columns, idx);
+
+		return e;
+	}
+
+	/** read-only element proxy */
+	ConstElement operator[](size_t idx) const
+	{
+		ConstElement e;
+
+		e.storage().attach(columns, idx);
+
+		return e;
+	}
+
+	/** contiguous column of the word containing #field */
+	template <typename TBitFieldDef::FIELDS field>
+	std::span<const TWord> column() const
+	{
+		return columns[TBitFieldDef::layout[field].word];
+	}
+
+	/** out[i] = element(i).get<field>() for all elements, scans the column of #field only */
+	template <typename TBitFieldDef::FIELDS field>
+	void get(std::span<TWord> out) const
+	{
+		const auto &entry = TBitFieldDef::layout[field];
+		const TWord mask = bitMask<TWord>(entry.lsb, entry.msb);
+		const auto &col = columns[entry.word];
+
+		static_assert(entry.access != AccessType::WRITE_ONLY, "reading from WO field");
+
+		for (size_t i = 0; i < out.size() && i < col.size(); i++) {
+			out[i] = static_cast<TWord>((BitFieldSetUtil<TBitFieldDef>::fromMemory(col[i]) & mask) >> entry.lsb);
+		}
+	}
+
+	/** fill collection from packed array, collection is resized to the array size */
+	void assign(std::span<const Packed> packed)
+	{
+		resize(packed.size());
+
+		for (size_t i = 0; i < packed.size(); i++) {
+			for (size_t w = 0; w < TBitFieldDef::wordCount; w++) {
+				columns[w][i] = packed[i].storage().words[w];
+			}
+		}
+	}
+
+	/** store collection into packed array, array should fit all elements */
+	void copyTo(std::span<Packed> packed) const
+	{
+		for (size_t i = 0; i < size() && i < packed.size(); i++) {
+			for (size_t w = 0; w < TBitFieldDef::wordCount; w++) {
+				packed[i].storage().words[w] = columns[w][i];
+			}
+		}
+	}
+
+private:
+	std::vector<TWord> columns[TBitFieldDef::wordCount];
+};
+
+}
+
+#endif /* BITFIELDSET_BITFIELDSET_SOA_HPP */
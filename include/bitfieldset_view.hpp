@@ -0,0 +1,222 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Dmitrii Lebed <lebed.dmitry@gmail.com>
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+/**
+ * Zero-copy bit field set view over external byte buffer
+ *
+ * View provides BitFieldSet API over words located in a buffer it does not own
+ * (packet, DMA buffer, etc). Words are accessed with memcpy, so there is no aliasing
+ * violation, alignment of the buffer is defined by compile time access policy.
+ * Const view over read-only buffer (e.g. received packet) provides read accessors only
+ */
+
+#ifndef BITFIELDSET_BITFIELDSET_VIEW_HPP
+#define BITFIELDSET_BITFIELDSET_VIEW_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <type_traits>
+
+#include "bitfieldset.hpp"
+
+namespace hal {
+
+/** View access policy: buffer is aligned to the word size, word access is a single aligned load/store */
+struct BitFieldViewAligned {
+	template <typename TWord>
+	static TWord load(const std::byte *ptr)
+	{
+		TWord value;
+
+		std::memcpy(&value, std::assume_aligned<alignof(TWord)>(ptr), sizeof(TWord));
+
+		return value;
+	}
+
+	template <typename TWord>
+	static void store(std::byte *ptr, TWord value)
+	{
+		std::memcpy(std::assume_aligned<alignof(TWord)>(ptr), &value, sizeof(TWord));
+	}
+};
+
+/**
+ * View access policy: buffer has no alignment requirements
+ *
+ * On targets with unaligned access support word access is still a single load/store,
+ * otherwise the compiler splits it into narrower accesses
+ */
+struct BitFieldViewUnaligned {
+	template <typename TWord>
+	static TWord load(const std::byte *ptr)
+	{
+		TWord value;
+
+		std::memcpy(&value, ptr, sizeof(TWord));
+
+		return value;
+	}
+
+	template <typename TWord>
+	static void store(std::byte *ptr, TWord value)
+	{
+		std::memcpy(ptr, &value, sizeof(TWord));
+	}
+};
+
+/**
+ * Storage policy of BitFieldSetView
+ *
+ * Word #i is located at byte offset i * sizeof(TWord) from the attached buffer start
+ *
+ * @tparam TAccess buffer access policy, BitFieldViewAligned or BitFieldViewUnaligned
+ */
+template <typename TBitFieldDef, typename TAccess>
+class BitFieldStorageView {
+public:
+	using TWord = typename TBitFieldDef::WordType;
+
+	/** buffer size required to hold all words */
+	static constexpr size_t size = TBitFieldDef::wordCount * sizeof(TWord);
+
+	constexpr void attach(std::byte *ptr)
+	{
+		if constexpr (std::is_same_v<TAccess, BitFieldViewAligned>) {
+			assert(reinterpret_cast<uintptr_t>(ptr) % alignof(TWord) == 0 && "buffer is misaligned");
+		}
+
+		buffer = ptr;
+	}
+
+	constexpr std::byte *data() const
+	{
+		return buffer;
+	}
+
+	template <size_t TWordIdx>
+	TWord load() const
+	{
+		return TAccess::template load<TWord>(buffer + TWordIdx * sizeof(TWord));
+	}
+
+	template <size_t TWordIdx>
+	void store(TWord value)
+	{
+		TAccess::template store<TWord>(buffer + TWordIdx * sizeof(TWord), value);
+	}
+
+	template <size_t TWordIdx, TWord mask>
+	void update(TWord bits)
+	{
+		store<TWordIdx>(static_cast<TWord>((load<TWordIdx>() & ~mask) | bits));
+	}
+
+	template <size_t TWordIdx, TWord mask>
+	bool compareExchange(TWord &expected, TWord desired)
+	{
+		const TWord word = load<TWordIdx>();
+
+		if ((word & mask) != expected) {
+			expected = word & mask;
+			return false;
+		}
+
+		store<TWordIdx>(static_cast<TWord>((word & ~mask) | desired));
+
+		return true;
+	}
+
+private:
+	std::byte *buffer;
+};
+
+/**
+ * Read-only storage policy of BitFieldSetConstView, provides load() only
+ *
+ * @tparam TAccess buffer access policy, BitFieldViewAligned or BitFieldViewUnaligned
+ */
+template <typename TBitFieldDef, typename TAccess>
+class BitFieldStorageConstView {
+public:
+	using TWord = typename TBitFieldDef::WordType;
+
+	/** buffer size required to hold all words */
+	static constexpr size_t size = TBitFieldDef::wordCount * sizeof(TWord);
+
+	constexpr void attach(const std::byte *ptr)
+	{
+		if constexpr (std::is_same_v<TAccess, BitFieldViewAligned>) {
+			assert(reinterpret_cast<uintptr_t>(ptr) % alignof(TWord) == 0 && "buffer is misaligned");
+		}
+
+		buffer = ptr;
+	}
+
+	constexpr const std::byte *data() const
+	{
+		return buffer;
+	}
+
+	template <size_t TWordIdx>
+	TWord load() const
+	{
+		return TAccess::template load<TWord>(buffer + TWordIdx * sizeof(TWord));
+	}
+
+private:
+	const std::byte *buffer;
+};
+
+/**
+ * Bit field set view
+ *
+ * @tparam TBitFieldDef bit field set layout definition
+ * @tparam TAccess buffer access policy, BitFieldViewAligned or BitFieldViewUnaligned
+ */
+template <typename TBitFieldDef, typename TAccess = BitFieldViewUnaligned>
+class BitFieldSetView : public BitFieldSet<TBitFieldDef, BitFieldStorageView<TBitFieldDef, TAccess>> {
+public:
+	/** buffer should be at least Storage::size bytes long (and word aligned for BitFieldViewAligned) */
+	explicit BitFieldSetView(std::span<std::byte> buffer) :
+		BitFieldSetView(buffer.data())
+	{
+		assert(buffer.size() >= BitFieldSetView::Storage::size && "buffer is too small");
+	}
+
+	explicit BitFieldSetView(void *ptr)
+	{
+		this->storage().attach(static_cast<std::byte *>(ptr));
+	}
+};
+
+/**
+ * Read-only bit field set view, modifying accessors do not compile
+ *
+ * @tparam TBitFieldDef bit field set layout definition
+ * @tparam TAccess buffer access policy, BitFieldViewAligned or BitFieldViewUnaligned
+ */
+template <typename TBitFieldDef, typename TAccess = BitFieldViewUnaligned>
+class BitFieldSetConstView : public BitFieldSet<TBitFieldDef, BitFieldStorageConstView<TBitFieldDef, TAccess>> {
+public:
+	/** buffer should be at least Storage::size bytes long (and word aligned for BitFieldViewAligned) */
+	explicit BitFieldSetConstView(std::span<const std::byte> buffer) :
+		BitFieldSetConstView(buffer.data())
+	{
+		assert(buffer.size() >= BitFieldSetConstView::Storage::size && "buffer is too small");
+	}
+
+	explicit BitFieldSetConstView(const void *ptr)
+	{
+		this->storage().attach(static_cast<const std::byte *>(ptr));
+	}
+};
+
+}
+
+#endif /* BITFIELDSET_BITFIELDSET_VIEW_HPP */
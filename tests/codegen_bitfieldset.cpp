@@ -0,0 +1,140 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Dmitrii Lebed <lebed.dmitry@gmail.com>
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+/*
+ * Generated code regression checks
+ *
+ * File is compiled with -O2 and disassembled, every function below is checked against
+ * the upper bounds given in "codegen:" comments (instructions, memory loads and stores).
+ * Bounds are measured with gcc 12 x86-64, check is not done for other compilers
+ */
+
+#include <bitfieldset.hpp>
+#include <bitfieldset_view.hpp>
+
+using namespace hal;
+
+struct CodegenBitFieldDef {
+	enum FIELDS {
+		F1,
+		F2,
+		F3,
+		F4,
+		F5,
+
+		/* keep last */
+		FIELD_COUNT
+	};
+
+	using WordType = uint32_t;
+
+	static constexpr size_t fieldCount = FIELD_COUNT;
+	static constexpr size_t wordCount = 2;
+
+	__extension__
+	static constexpr struct BitField<WordType> layout[fieldCount] =
+	{
+		[F1]	= { .word = 0,	.lsb = 0,	.msb = 2	},
+		[F2]	= { .word = 0,	.lsb = 3,	.msb = 4	},
+		[F3]	= { .word = 0,	.lsb = 5,	.msb = 15	},
+		[F4]	= { .word = 1,	.lsb = 0,	.msb = 7	},
+		[F5]	= { .word = 1,	.lsb = 8,	.msb = 31	},
+	};
+};
+
+using CBF = BitFieldSet<CodegenBitFieldDef>;
+
+struct CodegenBigEndianDef : CodegenBitFieldDef {
+	static constexpr std::endian endian = std::endian::big;
+};
+
+using CBEBF = BitFieldSet<CodegenBigEndianDef>;
+
+extern "C" {
+
+/* codegen: codegen_set insns=8 loads=1 stores=1 */
+void codegen_set(CBF &s, uint32_t v)
+{
+	s.set<CBF::F2>(v);
+}
+
+/* codegen: codegen_set_volatile insns=8 loads=1 stores=1 */
+void codegen_set_volatile(volatile CBF &s, uint32_t v)
+{
+	s.set<CBF::F2>(v);
+}
+
+/* codegen: codegen_set_batch_volatile insns=11 loads=1 stores=1 */
+void codegen_set_batch_volatile(volatile CBF &s, uint32_t v1, uint32_t v2)
+{
+	s.set<CBF::F1, CBF::F2>(v1, v2);
+}
+
+/* codegen: codegen_set_full_word_volatile insns=7 loads=0 stores=1 */
+void codegen_set_full_word_volatile(volatile CBF &s, uint32_t v1, uint32_t v2)
+{
+	s.set<CBF::F4, CBF::F5>(v1, v2);
+}
+
+/* codegen: codegen_modify_volatile insns=11 loads=1 stores=1 */
+void codegen_modify_volatile(volatile CBF &s, uint32_t v1, uint32_t v2)
+{
+	s.modify<CBF::F1>().set<CBF::F1>(v1).set<CBF::F3>(v2);
+}
+
+/* codegen: codegen_get insns=5 loads=1 stores=0 */
+uint32_t codegen_get(const CBF &s)
+{
+	return s.get<CBF::F3>();
+}
+
+/* codegen: codegen_get_volatile insns=5 loads=1 stores=0 */
+uint32_t codegen_get_volatile(const volatile CBF &s)
+{
+	return s.get<CBF::F3>();
+}
+
+/* codegen: codegen_word_get_volatile insns=13 loads=1 stores=0 */
+uint32_t codegen_word_get_volatile(const volatile CBF &s)
+{
+	const auto w = s.word<CBF::F1>();
+
+	return w.get<CBF::F1>() + w.get<CBF::F2>() + w.get<CBF::F3>();
+}
+
+/* codegen: codegen_get_big_endian insns=6 loads=1 stores=0 */
+uint32_t codegen_get_big_endian(const volatile CBEBF &s)
+{
+	return s.get<CBF::F3>();
+}
+
+/* byte swap is folded into the mask and the constant */
+/* codegen: codegen_equals_big_endian insns=6 loads=1 stores=0 */
+bool codegen_equals_big_endian(const volatile CBEBF &s)
+{
+	return s.equals<CBF::F3>(0x123);
+}
+
+/* words of the batch are flushed with straight-line stores */
+/* codegen: codegen_dirty_flush_batch insns=8 loads=3 stores=3 */
+void codegen_dirty_flush_batch(BitFieldSet<CodegenBitFieldDef, BitFieldStorageDirty<CodegenBitFieldDef>> &s,
+							   volatile CBF &dev)
+{
+	s.storage().flushTo<CBF::F1, CBF::F4>(dev);
+}
+
+/* codegen: codegen_view_get_unaligned insns=5 loads=1 stores=0 */
+uint32_t codegen_view_get_unaligned(std::byte *buf)
+{
+	return BitFieldSetView<CodegenBitFieldDef>(buf).get<CBF::F3>();
+}
+
+/* codegen: codegen_view_set_unaligned insns=8 loads=1 stores=1 */
+void codegen_view_set_unaligned(std::byte *buf, uint32_t v)
+{
+	BitFieldSetView<CodegenBitFieldDef>(buf).set<CBF::F5>(v);
+}
+
+}
@@ -5,6 +5,11 @@
 
 #include <gtest/gtest.h>
 
+#include <cstring>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
 #include <bitfieldset.hpp>
 
 using namespace hal;
@@ -45,6 +50,162 @@ struct TestBitFieldFlexDef {
 
 class TBF : public BitFieldSet<TestBitFieldFlexDef<uint32_t>> { };
 
+/* layout with reserved (undefined) bits 4..7 in word 0 */
+struct TestBitFieldReservedDef {
+	enum FIELDS {
+		R1,
+		R2,
+		R3,
+
+		/* keep last */
+		FIELD_COUNT
+	};
+
+	using WordType = uint16_t;
+
+	static constexpr size_t fieldCount = FIELD_COUNT;
+	static constexpr size_t wordCount = 2;
+
+	__extension__
+	static constexpr struct BitField<WordType> layout[fieldCount] =
+	{
+		[R1]	= { .word = 0,	.lsb = 0,	.msb = 3,	.def = 0x5	},
+		[R2]	= { .word = 0,	.lsb = 8,	.msb = 15,	.def = 0xa5	},
+		[R3]	= { .word = 1,	.lsb = 2,	.msb = 9,	.def = 0x3c	},
+	};
+};
+
+class TRBF : public BitFieldSet<TestBitFieldReservedDef> { };
+
+/* DMA descriptor with 48-bit address split across words */
+struct TestBitFieldCompoundDef {
+	enum FIELDS {
+		ADDR_LO,
+		ADDR_HI,
+		LEN,
+		CNT_LO,
+		CNT_HI,
+
+		/* keep last */
+		FIELD_COUNT
+	};
+
+	using WordType = uint32_t;
+
+	static constexpr size_t fieldCount = FIELD_COUNT;
+	static constexpr size_t wordCount = 3;
+
+	__extension__
+	static constexpr struct BitField<WordType> layout[fieldCount] =
+	{
+		[ADDR_LO]	= { .word = 0,	.lsb = 0,	.msb = 31,	.compoundOffset = 0		},
+		[ADDR_HI]	= { .word = 1,	.lsb = 0,	.msb = 15,	.compoundOffset = 32	},
+		[LEN]		= { .word = 1,	.lsb = 16,	.msb = 31							},
+		[CNT_LO]	= { .word = 2,	.lsb = 20,	.msb = 31,	.compoundOffset = 0		},
+		[CNT_HI]	= { .word = 2,	.lsb = 0,	.msb = 7,	.compoundOffset = 12	},
+	};
+};
+
+class TCBF : public BitFieldSet<TestBitFieldCompoundDef> { };
+
+/* packed counters of different width with a gap in word 0, same width counters in word 1 */
+struct TestBitFieldCounterDef {
+	enum FIELDS {
+		C0,
+		C1,
+		C2,
+		C3,
+		C4,
+		U0,
+		U1,
+		U2,
+		U3,
+
+		/* keep last */
+		FIELD_COUNT
+	};
+
+	using WordType = uint32_t;
+
+	static constexpr size_t fieldCount = FIELD_COUNT;
+	static constexpr size_t wordCount = 2;
+
+	__extension__
+	static constexpr struct BitField<WordType> layout[fieldCount] =
+	{
+		[C0]	= { .word = 0,	.lsb = 0,	.msb = 7	},
+		[C1]	= { .word = 0,	.lsb = 8,	.msb = 15	},
+		[C2]	= { .word = 0,	.lsb = 16,	.msb = 19	},
+		[C3]	= { .word = 0,	.lsb = 24,	.msb = 27	},
+		[C4]	= { .word = 0,	.lsb = 28,	.msb = 28	},
+		[U0]	= { .word = 1,	.lsb = 0,	.msb = 7	},
+		[U1]	= { .word = 1,	.lsb = 8,	.msb = 15	},
+		[U2]	= { .word = 1,	.lsb = 16,	.msb = 23	},
+		[U3]	= { .word = 1,	.lsb = 24,	.msb = 31	},
+	};
+};
+
+class TCntBF : public BitFieldSet<TestBitFieldCounterDef> { };
+
+/* register block with write-only command word and status/control word */
+struct TestBitFieldWODef {
+	enum FIELDS {
+		CMD_OP,
+		CMD_ARG,
+		STATUS,
+		CTRL,
+
+		/* keep last */
+		FIELD_COUNT
+	};
+
+	using WordType = uint32_t;
+
+	static constexpr size_t fieldCount = FIELD_COUNT;
+	static constexpr size_t wordCount = 2;
+
+	__extension__
+	static constexpr struct BitField<WordType> layout[fieldCount] =
+	{
+		[CMD_OP]	= { .word = 0,	.lsb = 0,	.msb = 7,	.access = AccessType::WRITE_ONLY	},
+		[CMD_ARG]	= { .word = 0,	.lsb = 8,	.msb = 31,	.access = AccessType::WRITE_ONLY	},
+		[STATUS]	= { .word = 1,	.lsb = 0,	.msb = 3,	.access = AccessType::READ_ONLY		},
+		[CTRL]		= { .word = 1,	.lsb = 4,	.msb = 7,	.def = 0x9							},
+	};
+};
+
+/* network header with big-endian words */
+struct TestBitFieldBigEndianDef {
+	enum FIELDS {
+		VER,
+		IHL,
+		TOS,
+		LEN,
+		TTL,
+
+		/* keep last */
+		FIELD_COUNT
+	};
+
+	using WordType = uint32_t;
+
+	static constexpr std::endian endian = std::endian::big;
+	static constexpr size_t fieldCount = FIELD_COUNT;
+	static constexpr size_t wordCount = 2;
+
+	__extension__
+	static constexpr struct BitField<WordType> layout[fieldCount] =
+	{
+		[VER]	= { .word = 0,	.lsb = 28,	.msb = 31,	.def = 4	},
+		[IHL]	= { .word = 0,	.lsb = 24,	.msb = 27,	.def = 5	},
+		[TOS]	= { .word = 0,	.lsb = 16,	.msb = 23				},
+		[LEN]	= { .word = 0,	.lsb = 0,	.msb = 15				},
+		[TTL]	= { .word = 1,	.lsb = 24,	.msb = 31,	.def = 64	},
+	};
+};
+
+class TBEBF : public BitFieldSet<TestBitFieldBigEndianDef> { };
+
 static_assert(std::is_trivial<TBF>::value, "BitFieldSet is not a trivial class");
 static_assert(std::is_standard_layout<TBF>::value, "BitFieldSet is not a standard layout class");
 
@@ -184,3 +345,616 @@ TEST(BitFieldSetTest, CascadedCV)
 	EXPECT_EQ(w0cv.get<TBF::F1>(), 3);
 	EXPECT_EQ(w0cv.get<TBF::F2>(), 2);
 }
+
+TEST(BitFieldSetTest, BatchSet)
+{
+	TBF tb;
+
+	tb.resetAll();
+
+	tb.set<TBF::F1, TBF::F4, TBF::F2, TBF::F5>(5, 0x1234, 1, 0x55);
+
+	EXPECT_EQ(tb.get<TBF::F1>(), 5);
+	EXPECT_EQ(tb.get<TBF::F2>(), 1);
+	EXPECT_EQ(tb.get<TBF::F3>(), 0);
+	EXPECT_EQ(tb.get<TBF::F4>(), 0x1234);
+	EXPECT_EQ(tb.get<TBF::F5>(), 0x55);
+
+	volatile TBF tbv = tb;
+
+	tbv.set<TBF::F2, TBF::F3>(2, 0x7);
+
+	EXPECT_EQ(tbv.get<TBF::F1>(), 5);
+	EXPECT_EQ(tbv.get<TBF::F2>(), 2);
+	EXPECT_EQ(tbv.get<TBF::F3>(), 0x7);
+	EXPECT_EQ(tbv.get<TBF::F4>(), 0x1234);
+}
+
+TEST(BitFieldSetTest, MutableWord)
+{
+	TBF tb;
+
+	tb.resetAll();
+
+	tb.set<TBF::F3>(0x11);
+
+	{
+		auto w0 = tb.modify<TBF::F1>();
+
+		w0.set<TBF::F1>(6).
+		   set<TBF::F2>(3);
+
+		EXPECT_EQ(w0.get<TBF::F1>(), 6);
+		/* nothing is written before commit */
+		EXPECT_EQ(tb.get<TBF::F1>(), 0);
+
+		w0.commit();
+
+		EXPECT_EQ(tb.get<TBF::F1>(), 6);
+
+		w0.set<TBF::F2>(1);
+	}
+
+	/* pending modification is written back on destruction */
+	EXPECT_EQ(tb.get<TBF::F1>(), 6);
+	EXPECT_EQ(tb.get<TBF::F2>(), 1);
+	EXPECT_EQ(tb.get<TBF::F3>(), 0x11);
+
+	volatile TBF tbv = tb;
+
+	tbv.modify<TBF::F2, WordInit::ZERO>().set<TBF::F2>(2);
+
+	EXPECT_EQ(tbv.get<TBF::F1>(), 0);
+	EXPECT_EQ(tbv.get<TBF::F2>(), 2);
+	EXPECT_EQ(tbv.get<TBF::F3>(), 0);
+
+	{
+		auto w1 = tbv.modify<TBF::F4>();
+
+		w1.set<TBF::F4>(0x77);
+		w1.discard();
+	}
+
+	EXPECT_EQ(tbv.get<TBF::F4>(), 0);
+}
+
+TEST(BitFieldSetTest, DefinedWordStore)
+{
+	static_assert(BitFieldSetUtil<TestBitFieldReservedDef>::definedMask(0) == 0xff0f);
+	static_assert(BitFieldSetUtil<TestBitFieldReservedDef>::definedMask(1) == 0x03fc);
+
+	TRBF tb;
+	uint16_t words[TRBF::wordCount] = { 0xffff, 0xffff };
+
+	std::memcpy(&tb, words, sizeof(words));
+
+	/* partial word update preserves reserved bits */
+	tb.set<TRBF::R1>(1);
+	std::memcpy(words, &tb, sizeof(words));
+	EXPECT_EQ(words[0], 0xfff1);
+
+	/* all defined bits are written, so the word is stored without reading it back */
+	tb.set<TRBF::R1, TRBF::R2>(2, 0x12);
+	tb.set<TRBF::R3>(0x3);
+	std::memcpy(words, &tb, sizeof(words));
+	EXPECT_EQ(words[0], 0x1202);
+	EXPECT_EQ(words[1], 0x000c);
+	EXPECT_EQ(tb.get<TRBF::R2>(), 0x12);
+	EXPECT_EQ(tb.word<TRBF::R1>().get<TRBF::R1>(), 2);
+}
+
+TEST(BitFieldSetTest, ShadowStorage)
+{
+	using Dev = BitFieldSet<TestBitFieldWODef>;
+	using Shadow = BitFieldSet<TestBitFieldWODef, BitFieldStorageShadow<TestBitFieldWODef>>;
+
+	uint32_t words[Dev::wordCount] = { 0xdeadbeef, 0x00000005 };
+	Dev dev;
+	Shadow sh;
+
+	std::memcpy(&dev, words, sizeof(words));
+
+	sh.storage().attach(dev);
+
+	/* readable fields start from the device, not from defaults */
+	EXPECT_EQ(sh.get<Shadow::STATUS>(), 0x5);
+	EXPECT_EQ(sh.get<Shadow::CTRL>(), 0);
+
+	/* write-only word is never read back from the device */
+	sh.set<Shadow::CMD_OP>(0x12);
+	std::memcpy(words, &dev, sizeof(words));
+	EXPECT_EQ(words[0], 0x12);
+
+	sh.set<Shadow::CMD_ARG>(0x345);
+	std::memcpy(words, &dev, sizeof(words));
+	EXPECT_EQ(words[0], 0x34512);
+
+	sh.modify<Shadow::CTRL>().set<Shadow::CTRL>(0x3);
+	std::memcpy(words, &dev, sizeof(words));
+	EXPECT_EQ(words[0], 0x34512);
+	EXPECT_EQ(words[1], 0x35);
+
+	/* hardware driven status is read from the device without sync() */
+	words[1] = 0x3a;
+	std::memcpy(&dev, words, sizeof(words));
+	EXPECT_EQ(sh.get<Shadow::STATUS>(), 0xa);
+	EXPECT_EQ(sh.get<Shadow::CTRL>(), 0x3);
+}
+
+TEST(BitFieldSetTest, ResetToDefaults)
+{
+	constexpr auto image = BitFieldSetUtil<TestBitFieldReservedDef>::defaultImage();
+
+	static_assert(image[0] == 0xa505);
+	static_assert(image[1] == 0x3c << 2);
+
+	TRBF tb;
+
+	tb.resetAll();
+	tb.resetToDefaults();
+
+	EXPECT_EQ(tb.get<TRBF::R1>(), 0x5);
+	EXPECT_EQ(tb.get<TRBF::R2>(), 0xa5);
+	EXPECT_EQ(tb.get<TRBF::R3>(), 0x3c);
+
+	volatile TRBF tbv;
+
+	tbv.resetAll();
+	tbv.resetToDefaults();
+
+	EXPECT_EQ(tbv.get<TRBF::R2>(), 0xa5);
+	EXPECT_EQ(tbv.get<TRBF::R3>(), 0x3c);
+}
+
+TEST(BitFieldSetTest, CompoundValue)
+{
+	TCBF tb;
+
+	tb.resetAll();
+
+	tb.set<TCBF::LEN>(0x1234);
+	tb.setCompound<TCBF::ADDR_LO, TCBF::ADDR_HI>(0xabcd87654321ULL);
+
+	EXPECT_EQ(tb.get<TCBF::ADDR_LO>(), 0x87654321);
+	EXPECT_EQ(tb.get<TCBF::ADDR_HI>(), 0xabcd);
+	EXPECT_EQ(tb.get<TCBF::LEN>(), 0x1234);
+	EXPECT_EQ((tb.getCompound<TCBF::ADDR_LO, TCBF::ADDR_HI>()), 0xabcd87654321ULL);
+
+	/* both parts are located in the same word */
+	volatile TCBF tbv = tb;
+
+	tbv.setCompound<TCBF::CNT_LO, TCBF::CNT_HI>(0xedcbaULL);
+
+	EXPECT_EQ(tbv.get<TCBF::CNT_LO>(), 0xcba);
+	EXPECT_EQ(tbv.get<TCBF::CNT_HI>(), 0xed);
+	EXPECT_EQ((tbv.getCompound<TCBF::CNT_LO, TCBF::CNT_HI>()), 0xedcbaULL);
+	EXPECT_EQ((tbv.getCompound<TCBF::ADDR_HI, TCBF::ADDR_LO>()), 0xabcd87654321ULL);
+}
+
+TEST(BitFieldSetTest, AtomicStorage)
+{
+	using Def = TestBitFieldFlexDef<uint32_t>;
+	using ATBF = BitFieldSet<Def, BitFieldStorageAtomic<Def>>;
+	constexpr unsigned iterations = 10000;
+
+	ATBF tb;
+
+	tb.resetAll();
+
+	/* concurrent updates of different fields of the same word */
+	std::vector<std::thread> threads;
+
+	threads.emplace_back([&tb]() {
+		for (unsigned i = 0; i < iterations; i++) {
+			tb.set<ATBF::F1>(i & 0x7);
+		}
+	});
+	threads.emplace_back([&tb]() {
+		for (unsigned i = 0; i < iterations; i++) {
+			tb.set<ATBF::F2>(i & 0x3);
+		}
+	});
+	threads.emplace_back([&tb]() {
+		for (unsigned i = 0; i < iterations; i++) {
+			tb.set<ATBF::F3>(i);
+		}
+	});
+
+	for (auto &t : threads) {
+		t.join();
+	}
+
+	EXPECT_EQ(tb.get<ATBF::F1>(), (iterations - 1) & 0x7);
+	EXPECT_EQ(tb.get<ATBF::F2>(), (iterations - 1) & 0x3);
+	EXPECT_EQ(tb.get<ATBF::F3>(), iterations - 1);
+
+	tb.set<ATBF::F6>(0x12345678);
+	EXPECT_EQ(tb.get<ATBF::F6>(), 0x12345678);
+}
+
+TEST(BitFieldSetTest, CompareExchange)
+{
+	TBF tb;
+	TBF::WordType expected = 1;
+
+	tb.resetAll();
+	tb.set<TBF::F3>(0x42);
+
+	EXPECT_FALSE(tb.compareExchange<TBF::F1>(expected, 5));
+	EXPECT_EQ(expected, 0);
+	EXPECT_TRUE(tb.compareExchange<TBF::F1>(expected, 5));
+	EXPECT_EQ(tb.get<TBF::F1>(), 5);
+	EXPECT_EQ(tb.get<TBF::F3>(), 0x42);
+
+	EXPECT_FALSE((tb.transition<TBF::F1, TBF::F2>({ 5, 1 }, { 2, 3 })));
+	EXPECT_EQ(tb.get<TBF::F1>(), 5);
+	EXPECT_TRUE((tb.transition<TBF::F1, TBF::F2>({ 5, 0 }, { 2, 3 })));
+	EXPECT_EQ(tb.get<TBF::F1>(), 2);
+	EXPECT_EQ(tb.get<TBF::F2>(), 3);
+	EXPECT_EQ(tb.get<TBF::F3>(), 0x42);
+}
+
+TEST(BitFieldSetTest, AtomicTransition)
+{
+	using Def = TestBitFieldFlexDef<uint32_t>;
+	using ATBF = BitFieldSet<Def, BitFieldStorageAtomic<Def, std::memory_order_acq_rel>>;
+	constexpr unsigned threadCount = 4;
+	constexpr unsigned iterations = 1000;
+
+	ATBF tb;
+
+	tb.resetAll();
+
+	/* F1 is used as an owner id (0 - free), F3 counts ownership acquisitions */
+	std::vector<std::thread> threads;
+
+	for (unsigned t = 1; t <= threadCount; t++) {
+		threads.emplace_back([&tb, t]() {
+			for (unsigned i = 0; i < iterations; i++) {
+				ATBF::WordType count;
+
+				do {
+					count = tb.get<ATBF::F3>();
+				} while (!tb.transition<ATBF::F1, ATBF::F3>({ 0, count }, { t, count + 1 }));
+
+				ATBF::WordType owner = t;
+
+				EXPECT_TRUE(tb.compareExchange<ATBF::F1>(owner, 0));
+			}
+		});
+	}
+
+	for (auto &t : threads) {
+		t.join();
+	}
+
+	EXPECT_EQ(tb.get<ATBF::F1>(), 0);
+	EXPECT_EQ(tb.get<ATBF::F3>(), threadCount * iterations);
+}
+
+TEST(BitFieldSetTest, SwarCounters)
+{
+	using Def = TestBitFieldCounterDef;
+	constexpr TCntBF::FIELDS word0[] = { TCntBF::C0, TCntBF::C1, TCntBF::C2, TCntBF::C3, TCntBF::C4 };
+	constexpr uint32_t reserved = 0xe0f00000;
+
+	/* compare with lane-by-lane reference implementation */
+	const uint32_t samples[] = { 0, 0xffffffff, 0x12345678, 0x1f0f80ff, 0x0a05017f, 0xdeadbeef };
+
+	for (uint32_t a : samples) {
+		for (uint32_t b : samples) {
+			const uint32_t sum = TCntBF::Swar<TCntBF::C0>::add(a, b);
+			const uint32_t sat = TCntBF::Swar<TCntBF::C0>::addSaturated(a, b);
+			const uint32_t eq = TCntBF::Swar<TCntBF::C0>::equal(a, b);
+
+			EXPECT_EQ(sum & reserved, a & reserved);
+			EXPECT_EQ(sat & reserved, a & reserved);
+			EXPECT_EQ(eq & reserved, 0);
+
+			for (auto f : word0) {
+				const auto &entry = Def::layout[f];
+				const uint32_t mask = bitMask<uint32_t>(entry.lsb, entry.msb);
+				const uint32_t fa = (a & mask) >> entry.lsb;
+				const uint32_t fb = (b & mask) >> entry.lsb;
+				const uint32_t max = mask >> entry.lsb;
+
+				EXPECT_EQ((sum & mask) >> entry.lsb, (fa + fb) & max);
+				EXPECT_EQ((sat & mask) >> entry.lsb, std::min(fa + fb, max));
+				EXPECT_EQ(eq & mask, fa == fb ? mask : 0);
+			}
+		}
+	}
+
+	TCntBF tb;
+
+	tb.resetAll();
+	tb.set<TCntBF::U0, TCntBF::U1, TCntBF::U2, TCntBF::U3>(0, 0xfe, 0xff, 7);
+
+	tb.swarIncrement<TCntBF::U0, true>();
+	tb.swarIncrement<TCntBF::U0, true>();
+
+	EXPECT_EQ(tb.get<TCntBF::U0>(), 2);
+	EXPECT_EQ(tb.get<TCntBF::U1>(), 0xff);
+	EXPECT_EQ(tb.get<TCntBF::U2>(), 0xff);
+	EXPECT_EQ(tb.get<TCntBF::U3>(), 9);
+
+	tb.swarAdd<TCntBF::U0>(TCntBF::Swar<TCntBF::U0>::splat(1));
+
+	EXPECT_EQ(tb.get<TCntBF::U0>(), 3);
+	EXPECT_EQ(tb.get<TCntBF::U1>(), 0);
+	EXPECT_EQ(tb.get<TCntBF::U2>(), 0);
+	EXPECT_EQ(tb.get<TCntBF::U3>(), 10);
+
+	EXPECT_EQ(tb.swarEqual<TCntBF::U0>(0x0a00ff03), 0xffff00ff);
+}
+
+TEST(BitFieldSetTest, RuntimeFieldIndex)
+{
+	using Dev = BitFieldSet<TestBitFieldWODef>;
+	TBF tb;
+
+	tb.resetAll();
+
+	for (size_t i = 0; i < TBF::FIELD_COUNT; i++) {
+		tb.set(static_cast<TBF::FIELDS>(i), static_cast<uint32_t>(i + 1));
+	}
+
+	EXPECT_EQ(tb.get<TBF::F1>(), 1);
+	EXPECT_EQ(tb.get<TBF::F2>(), 2);
+	EXPECT_EQ(tb.get<TBF::F3>(), 3);
+	EXPECT_EQ(tb.get<TBF::F4>(), 4);
+	EXPECT_EQ(tb.get<TBF::F5>(), 5);
+	EXPECT_EQ(tb.get<TBF::F6>(), 6);
+
+	/* value is truncated to the field width */
+	tb.set(TBF::F2, 0xff);
+	EXPECT_EQ(tb.get(TBF::F2), 0x3);
+	EXPECT_EQ(tb.get(TBF::F1), 1);
+	EXPECT_EQ(tb.get(TBF::F3), 3);
+
+	/* out of range field is ignored */
+	tb.set(TBF::FIELD_COUNT, 0x1);
+	EXPECT_EQ(tb.get(TBF::FIELD_COUNT), 0);
+
+	volatile TBF &tbv = tb;
+
+	tbv.set(TBF::F5, 0x1234);
+	EXPECT_EQ(tbv.get(TBF::F5), 0x1234);
+	EXPECT_EQ(tbv.get(TBF::F4), 4);
+
+	/* RO field is not written, WO field reads as zero */
+	uint32_t words[Dev::wordCount] = { 0x12345678, 0x00000005 };
+	Dev dev;
+
+	std::memcpy(&dev, words, sizeof(words));
+
+	dev.set(Dev::STATUS, 0xa);
+	dev.set(Dev::CTRL, 0x3);
+	EXPECT_EQ(dev.get(Dev::STATUS), 0x5);
+	EXPECT_EQ(dev.get(Dev::CTRL), 0x3);
+	EXPECT_EQ(dev.get(Dev::CMD_OP), 0);
+
+	/* per-word accessor table path of non-default storage policies */
+	BitFieldSet<TestBitFieldWODef, BitFieldStorageAtomic<TestBitFieldWODef>> devAtomic;
+
+	std::memcpy(&devAtomic, words, sizeof(words));
+
+	devAtomic.set(Dev::CTRL, 0x2);
+	devAtomic.set(Dev::STATUS, 0xa);
+	devAtomic.set(Dev::FIELD_COUNT, 0x1);
+	EXPECT_EQ(devAtomic.get(Dev::CTRL), 0x2);
+	EXPECT_EQ(devAtomic.get(Dev::STATUS), 0x5);
+	EXPECT_EQ(devAtomic.get(Dev::CMD_OP), 0);
+	EXPECT_EQ(devAtomic.get(Dev::FIELD_COUNT), 0);
+
+	/* direct path converts byte order */
+	TBEBF be;
+
+	be.resetToDefaults();
+	be.set(TBEBF::TTL, 32);
+	EXPECT_EQ(be.get(TBEBF::TTL), 32);
+	EXPECT_EQ(be.get<TBEBF::TTL>(), 32);
+	EXPECT_EQ(be.get(TBEBF::IHL), 5);
+}
+
+static constexpr uint32_t testUnpackConstexpr()
+{
+	BitFieldSet<TestBitFieldCompoundDef> tb = {};
+
+	tb.pack<TCBF::LEN, TCBF::CNT_HI, TCBF::ADDR_HI>({ 0x1234, 0x5a, 0x77 });
+
+	const auto v = tb.unpack<TCBF::ADDR_HI, TCBF::LEN, TCBF::CNT_HI>();
+
+	return v[0] + v[1] + v[2];
+}
+
+TEST(BitFieldSetTest, UnpackPack)
+{
+	static_assert(testUnpackConstexpr() == 0x77 + 0x1234 + 0x5a);
+
+	TCBF tb;
+
+	tb.resetAll();
+	tb.set<TCBF::ADDR_LO, TCBF::LEN, TCBF::CNT_LO>(0xdeadbeef, 0x1234, 0xabc);
+
+	/* fields are listed out of layout order and span several words */
+	const auto v = tb.unpack<TCBF::LEN, TCBF::CNT_LO, TCBF::ADDR_LO, TCBF::ADDR_HI>();
+
+	EXPECT_EQ(v[0], 0x1234);
+	EXPECT_EQ(v[1], 0xabc);
+	EXPECT_EQ(v[2], 0xdeadbeef);
+	EXPECT_EQ(v[3], 0);
+
+	/* values wider than the field are truncated and do not leak into neighbours */
+	tb.pack<TCBF::CNT_HI, TCBF::ADDR_HI>({ 0x1ff, 0x12345 });
+
+	EXPECT_EQ(tb.get<TCBF::CNT_HI>(), 0xff);
+	EXPECT_EQ(tb.get<TCBF::CNT_LO>(), 0xabc);
+	EXPECT_EQ(tb.get<TCBF::ADDR_HI>(), 0x2345);
+	EXPECT_EQ(tb.get<TCBF::LEN>(), 0x1234);
+
+	volatile TCBF &tbv = tb;
+
+	tbv.pack<TCBF::LEN, TCBF::ADDR_HI>({ 0x4321, 0x1 });
+
+	const auto vv = tbv.unpack<TCBF::ADDR_HI, TCBF::LEN, TCBF::CNT_HI>();
+
+	EXPECT_EQ(vv[0], 0x1);
+	EXPECT_EQ(vv[1], 0x4321);
+	EXPECT_EQ(vv[2], 0xff);
+}
+
+TEST(BitFieldSetTest, BigEndianLayout)
+{
+	static_assert(BitFieldSetUtil<TestBitFieldBigEndianDef>::byteOrder() == std::endian::big);
+	static_assert(BitFieldSetUtil<TestBitFieldReservedDef>::byteOrder() == std::endian::native);
+
+	const uint8_t header[] = { 0x45, 0x10, 0x05, 0xdc, 0x40, 0x00, 0x00, 0x00 };
+	TBEBF tb;
+
+	std::memcpy(&tb, header, sizeof(header));
+
+	EXPECT_EQ(tb.get<TBEBF::VER>(), 4);
+	EXPECT_EQ(tb.get<TBEBF::IHL>(), 5);
+	EXPECT_EQ(tb.get<TBEBF::TOS>(), 0x10);
+	EXPECT_EQ(tb.get<TBEBF::LEN>(), 1500);
+	EXPECT_EQ(tb.get<TBEBF::TTL>(), 64);
+	EXPECT_EQ(tb.word<TBEBF::LEN>().get<TBEBF::TOS>(), 0x10);
+	EXPECT_EQ(tb.get(TBEBF::LEN), 1500);
+	EXPECT_TRUE(tb.equals<TBEBF::LEN>(1500));
+	EXPECT_FALSE(tb.equals<TBEBF::VER>(6));
+
+	uint8_t out[sizeof(header)];
+
+	tb.set<TBEBF::LEN>(0x1234);
+	tb.modify<TBEBF::TTL>().set<TBEBF::TTL>(0x7f);
+	std::memcpy(out, &tb, sizeof(out));
+
+	EXPECT_EQ(out[2], 0x12);
+	EXPECT_EQ(out[3], 0x34);
+	EXPECT_EQ(out[4], 0x7f);
+	EXPECT_EQ(out[0], 0x45);
+
+	uint32_t expected = 0x10;
+
+	EXPECT_TRUE(tb.compareExchange<TBEBF::TOS>(expected, 0x20));
+	EXPECT_FALSE(tb.compareExchange<TBEBF::TOS>(expected, 0x30));
+	EXPECT_EQ(expected, 0x20);
+
+	tb.resetToDefaults();
+	std::memcpy(out, &tb, sizeof(out));
+
+	EXPECT_EQ(out[0], 0x45);
+	EXPECT_EQ(out[1], 0);
+	EXPECT_EQ(out[4], 64);
+}
+
+TEST(BitFieldSetTest, DirtyFlush)
+{
+	using Def = TestBitFieldFlexDef<uint32_t>;
+	using Dev = BitFieldSet<Def>;
+	using Work = BitFieldSet<Def, BitFieldStorageDirty<Def>>;
+
+	Dev dev;
+	Work work;
+
+	dev.resetAll();
+	work.resetAll();
+	work.storage().flushTo(dev);
+
+	for (size_t i = 0; i < Def::wordCount; i++) {
+		EXPECT_FALSE(work.storage().isDirty(i));
+	}
+
+	work.set<Work::F2>(3);
+	work.set<Work::F6>(0x1234);
+
+	EXPECT_TRUE(work.storage().isDirty(0));
+	EXPECT_FALSE(work.storage().isDirty(1));
+	EXPECT_TRUE(work.storage().isDirty(2));
+
+	/* clean words are not written */
+	dev.set<Dev::F4>(0x55);
+	work.storage().flushTo(dev);
+
+	EXPECT_EQ(dev.get<Dev::F2>(), 3);
+	EXPECT_EQ(dev.get<Dev::F4>(), 0x55);
+	EXPECT_EQ(dev.get<Dev::F6>(), 0x1234);
+	EXPECT_FALSE(work.storage().isDirty(0));
+	EXPECT_FALSE(work.storage().isDirty(2));
+
+	/* compile time flush of the batch words */
+	work.set<Work::F1, Work::F5>(7, 0x3);
+	work.set<Work::F6>(0x1);
+	work.storage().flushTo<Work::F1, Work::F5>(dev);
+
+	EXPECT_EQ(dev.get<Dev::F1>(), 7);
+	EXPECT_EQ(dev.get<Dev::F5>(), 0x3);
+	EXPECT_EQ(dev.get<Dev::F6>(), 0x1234);
+	EXPECT_FALSE(work.storage().isDirty(0));
+	EXPECT_FALSE(work.storage().isDirty(1));
+	EXPECT_TRUE(work.storage().isDirty(2));
+}
+
+TEST(BitFieldSetTest, DefinedBitsEqualityHash)
+{
+	using Set = BitFieldSet<TestBitFieldReservedDef>;
+
+	constexpr auto defined = BitFieldSetUtil<TestBitFieldReservedDef>::definedImage();
+
+	static_assert(defined[0] == 0xff0f);
+	static_assert(defined[1] == 0x03fc);
+
+	Set a;
+	Set b;
+
+	a.resetToDefaults();
+	b.resetToDefaults();
+
+	/* difference in reserved bits only */
+	b.storage().words[0] |= 0x00f0;
+	b.storage().words[1] |= 0xc003;
+
+	EXPECT_TRUE(a.equalsDefined(b));
+	EXPECT_EQ(std::hash<Set>{}(a), std::hash<Set>{}(b));
+
+	b.set<Set::R3>(0x3d);
+
+	EXPECT_FALSE(a.equalsDefined(b));
+	EXPECT_NE(std::hash<Set>{}(a), std::hash<Set>{}(b));
+
+	std::vector<size_t> hashes;
+
+	for (uint16_t i = 0; i < 256; i++) {
+		a.set<Set::R2>(i);
+		hashes.push_back(a.hashDefined());
+	}
+
+	std::sort(hashes.begin(), hashes.end());
+	EXPECT_EQ(std::unique(hashes.begin(), hashes.end()), hashes.end());
+}
+
+TEST(BitFieldSetTest, DefinedBitsUnorderedSet)
+{
+	/* derived class as a key */
+	std::unordered_set<TRBF, BitFieldSetHash, BitFieldSetEqualDefined> seen;
+	TRBF a;
+	TRBF b;
+
+	a.resetToDefaults();
+	b.resetToDefaults();
+	b.storage().words[0] |= 0x00f0;
+
+	EXPECT_TRUE(seen.insert(a).second);
+	EXPECT_FALSE(seen.insert(b).second);
+
+	b.set<TRBF::R1>(0x7);
+
+	EXPECT_TRUE(seen.insert(b).second);
+	EXPECT_EQ(seen.size(), 2);
+	EXPECT_EQ(seen.count(a), 1);
+
+	const BitFieldSet<TestBitFieldReservedDef> &base = a;
+
+	EXPECT_EQ(BitFieldSetHash{}(a), std::hash<BitFieldSet<TestBitFieldReservedDef>>{}(base));
+}
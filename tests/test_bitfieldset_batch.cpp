@@ -0,0 +1,142 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Dmitrii Lebed <lebed.dmitry@gmail.com>
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <bitfieldset_batch.hpp>
+
+using namespace hal;
+
+template <typename TWord>
+struct TestBatchDescDef {
+	static constexpr size_t bits = std::numeric_limits<TWord>::digits;
+
+	enum FIELDS {
+		LEN,
+		STATUS,
+		FLAGS,
+		ADDR,
+
+		/* keep last */
+		FIELD_COUNT
+	};
+
+	using WordType = TWord;
+
+	static constexpr size_t fieldCount = FIELD_COUNT;
+	static constexpr size_t wordCount = 3;
+
+	__extension__
+	static constexpr struct BitField<WordType> layout[fieldCount] =
+	{
+		[LEN]		= { .word = 0,	.lsb = 0,			.msb = bits / 2 - 1	},
+		[STATUS]	= { .word = 0,	.lsb = bits / 2,	.msb = bits / 2 + 3	},
+		[FLAGS]		= { .word = 1,	.lsb = 3,			.msb = 6			},
+		[ADDR]		= { .word = 2,	.lsb = 0,			.msb = bits - 1		},
+	};
+};
+
+template <typename TWord, BitFieldBatchKernel kernel = BitFieldBatchKernel::AUTO>
+void batchTest()
+{
+	using Desc = BitFieldSet<TestBatchDescDef<TWord>>;
+	using Batch = BitFieldSetBatch<Desc>;
+	/* odd count to cover vector loop tail */
+	constexpr size_t count = 37;
+
+	std::vector<Desc> ring(count);
+	std::vector<TWord> values(count);
+	std::vector<TWord> out(count);
+	std::vector<TWord> lens(count);
+
+	for (size_t i = 0; i < count; i++) {
+		ring[i].resetAll();
+		ring[i].template set<Desc::LEN, Desc::STATUS, Desc::FLAGS, Desc::ADDR>(
+			static_cast<TWord>(i * 3), static_cast<TWord>(i & 0xf),
+			static_cast<TWord>(~i & 0xf), static_cast<TWord>(i * 7));
+		values[i] = static_cast<TWord>(i + 5);
+		lens[i] = ring[i].template get<Desc::LEN>();
+	}
+
+	/* no elements: nothing is accessed, data() of an empty vector is null */
+	std::vector<Desc> none;
+	std::vector<TWord> noValues;
+
+	Batch::template get<Desc::LEN, kernel>(none.data(), 0, noValues.data());
+	Batch::template set<Desc::STATUS, kernel>(none.data(), 0, noValues.data());
+	Batch::template set<Desc::FLAGS, kernel>(none.data(), 0, static_cast<TWord>(0xa));
+
+	Batch::template get<Desc::LEN, kernel>(ring.data(), count, out.data());
+
+	for (size_t i = 0; i < count; i++) {
+		EXPECT_EQ(out[i], lens[i]);
+	}
+
+	Batch::template get<Desc::STATUS, kernel>(ring.data(), count, out.data());
+
+	for (size_t i = 0; i < count; i++) {
+		EXPECT_EQ(out[i], i & 0xf);
+	}
+
+	Batch::template set<Desc::STATUS, kernel>(ring.data(), count, values.data());
+	Batch::template set<Desc::FLAGS, kernel>(ring.data(), count, static_cast<TWord>(0xa));
+	Batch::template set<Desc::ADDR, kernel>(ring.data(), count, values.data());
+
+	for (size_t i = 0; i < count; i++) {
+		EXPECT_EQ(ring[i].template get<Desc::LEN>(), lens[i]);
+		EXPECT_EQ(ring[i].template get<Desc::STATUS>(), (i + 5) & 0xf);
+		EXPECT_EQ(ring[i].template get<Desc::FLAGS>(), 0xa);
+		EXPECT_EQ(ring[i].template get<Desc::ADDR>(), static_cast<TWord>(i + 5));
+	}
+}
+
+TEST(BitFieldSetBatchTest, GetSet)
+{
+	batchTest<uint8_t>();
+	batchTest<uint16_t>();
+	batchTest<uint32_t>();
+	batchTest<uint64_t>();
+}
+
+/* every kernel is checked against per-set accessors regardless of the one AUTO picks */
+template <BitFieldBatchKernel kernel>
+bool kernelTest()
+{
+	if (!BitFieldSetBatch<BitFieldSet<TestBatchDescDef<uint32_t>>>::supported(kernel) ||
+		!BitFieldSetBatch<BitFieldSet<TestBatchDescDef<uint64_t>>>::supported(kernel)) {
+		return false;
+	}
+
+	batchTest<uint32_t, kernel>();
+	batchTest<uint64_t, kernel>();
+
+	return true;
+}
+
+TEST(BitFieldSetBatchTest, KernelScalar)
+{
+	EXPECT_TRUE(kernelTest<BitFieldBatchKernel::SCALAR>());
+	batchTest<uint8_t, BitFieldBatchKernel::SCALAR>();
+	batchTest<uint16_t, BitFieldBatchKernel::SCALAR>();
+}
+
+TEST(BitFieldSetBatchTest, KernelAvx2)
+{
+	if (!kernelTest<BitFieldBatchKernel::AVX2>()) {
+		GTEST_SKIP() << "AVX2 kernel is not supported";
+	}
+
+	/* no gather for narrow words */
+	EXPECT_FALSE(BitFieldSetBatch<BitFieldSet<TestBatchDescDef<uint16_t>>>::supported(BitFieldBatchKernel::AVX2));
+}
+
+TEST(BitFieldSetBatchTest, KernelAvx512)
+{
+	if (!kernelTest<BitFieldBatchKernel::AVX512>()) {
+		GTEST_SKIP() << "AVX-512 kernel is not supported";
+	}
+}
@@ -0,0 +1,103 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Dmitrii Lebed <lebed.dmitry@gmail.com>
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <bitfieldset_diff.hpp>
+
+using namespace hal;
+
+/* status block with reserved bits 8..15 in word 0 and overlapping alias in word 2 */
+struct TestDiffStatusDef {
+	enum FIELDS {
+		STATE,
+		ERR,
+		COUNT,
+		ADDR,
+		FLAG0,
+		FLAG1,
+		FLAGS,
+
+		/* keep last */
+		FIELD_COUNT
+	};
+
+	using WordType = uint32_t;
+
+	static constexpr size_t fieldCount = FIELD_COUNT;
+	static constexpr size_t wordCount = 3;
+
+	__extension__
+	static constexpr struct BitField<WordType> layout[fieldCount] =
+	{
+		[STATE]	= { .word = 0,	.lsb = 0,	.msb = 3	},
+		[ERR]	= { .word = 0,	.lsb = 4,	.msb = 7	},
+		[COUNT]	= { .word = 0,	.lsb = 16,	.msb = 31	},
+		[ADDR]	= { .word = 1,	.lsb = 0,	.msb = 31	},
+		[FLAG0]	= { .word = 2,	.lsb = 0,	.msb = 0	},
+		[FLAG1]	= { .word = 2,	.lsb = 1,	.msb = 1	},
+		[FLAGS]	= { .word = 2,	.lsb = 0,	.msb = 1,	.mayOverlap = true	},
+	};
+};
+
+using Status = BitFieldSet<TestDiffStatusDef>;
+
+TEST(BitFieldSetDiffTest, ChangedFields)
+{
+	Status a;
+	Status b;
+
+	a.resetAll();
+	b.resetAll();
+
+	EXPECT_FALSE(diff(a, b).any());
+
+	/* several bits of one field are reported once, reserved bits are ignored */
+	b.set<Status::COUNT>(0xffff);
+	b.set<Status::ERR>(1);
+	b.storage().words[0] |= 0xff00;
+
+	auto d = diff(a, b);
+
+	EXPECT_TRUE(d.any());
+	EXPECT_EQ(d.count(), 2);
+	EXPECT_TRUE(d.test(Status::ERR));
+	EXPECT_TRUE(d.test(Status::COUNT));
+	EXPECT_FALSE(d.test(Status::STATE));
+	EXPECT_EQ(d.bits()[0], bit<uint64_t>(Status::ERR) | bit<uint64_t>(Status::COUNT));
+
+	/* overlapping fields are all reported */
+	b.set<Status::FLAG1>(1);
+	b.set<Status::ADDR>(0x1000);
+
+	std::vector<Status::FIELDS> changed;
+
+	for (auto f : diff(a, b)) {
+		changed.push_back(f);
+	}
+
+	const std::vector<Status::FIELDS> expected = {
+		Status::ERR, Status::COUNT, Status::ADDR, Status::FLAG1, Status::FLAGS
+	};
+
+	EXPECT_EQ(changed, expected);
+}
+
+static constexpr size_t testDiffConstexpr()
+{
+	Status a = {};
+	Status b = {};
+
+	b.set<Status::STATE, Status::ADDR>(1, 2);
+
+	return diff(a, b).count();
+}
+
+TEST(BitFieldSetDiffTest, Constexpr)
+{
+	static_assert(testDiffConstexpr() == 2);
+}
@@ -0,0 +1,121 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Dmitrii Lebed <lebed.dmitry@gmail.com>
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <bitfieldset_soa.hpp>
+
+using namespace hal;
+
+struct TestSoADescDef {
+	enum FIELDS {
+		LEN,
+		STATUS,
+		ADDR,
+
+		/* keep last */
+		FIELD_COUNT
+	};
+
+	using WordType = uint32_t;
+
+	static constexpr size_t fieldCount = FIELD_COUNT;
+	static constexpr size_t wordCount = 2;
+
+	__extension__
+	static constexpr struct BitField<WordType> layout[fieldCount] =
+	{
+		[LEN]		= { .word = 0,	.lsb = 0,	.msb = 15	},
+		[STATUS]	= { .word = 0,	.lsb = 16,	.msb = 19	},
+		[ADDR]		= { .word = 1,	.lsb = 0,	.msb = 31	},
+	};
+};
+
+using SoA = BitFieldSetSoA<TestSoADescDef>;
+
+template <typename TStorage>
+constexpr bool hasStore = requires(TStorage &st) {
+	st.template store<0>(0u);
+	st.template update<0, 0xfu>(0u);
+};
+
+TEST(BitFieldSetSoATest, ElementAccess)
+{
+	constexpr size_t count = 100;
+	SoA soa(count);
+
+	EXPECT_EQ(soa.size(), count);
+
+	for (size_t i = 0; i < count; i++) {
+		auto e = soa[i];
+
+		e.resetAll();
+		e.set<SoA::Element::LEN, SoA::Element::STATUS>(static_cast<uint32_t>(i * 10), i & 0xf);
+		e.set<SoA::Element::ADDR>(static_cast<uint32_t>(0x1000 + i));
+	}
+
+	const SoA &csoa = soa;
+
+	for (size_t i = 0; i < count; i++) {
+		EXPECT_EQ(csoa[i].get<SoA::Element::LEN>(), i * 10);
+		EXPECT_EQ(csoa[i].get<SoA::Element::STATUS>(), i & 0xf);
+		EXPECT_EQ(csoa[i].get<SoA::Element::ADDR>(), 0x1000 + i);
+	}
+
+	std::vector<uint32_t> status(count);
+
+	soa.get<SoA::Element::STATUS>(status);
+
+	for (size_t i = 0; i < count; i++) {
+		EXPECT_EQ(status[i], i & 0xf);
+	}
+
+	/* const container hands out read-only proxies */
+	static_assert(std::is_same_v<decltype(csoa[0]), SoA::ConstElement>);
+	static_assert(hasStore<SoA::Element::Storage>);
+	static_assert(!hasStore<SoA::ConstElement::Storage>);
+
+	auto ce = csoa[3];
+
+	EXPECT_EQ(ce.get<SoA::Element::ADDR>(), 0x1003);
+	EXPECT_TRUE(ce.equals<SoA::Element::LEN>(30));
+
+	EXPECT_EQ(soa.column<SoA::Element::ADDR>().size(), count);
+	EXPECT_EQ(soa.column<SoA::Element::ADDR>()[5], 0x1005);
+}
+
+TEST(BitFieldSetSoATest, PackedConversion)
+{
+	constexpr size_t count = 10;
+	std::vector<SoA::Packed> packed(count);
+
+	for (size_t i = 0; i < count; i++) {
+		packed[i].resetAll();
+		packed[i].set<SoA::Packed::LEN, SoA::Packed::ADDR>(static_cast<uint32_t>(i), static_cast<uint32_t>(i * 3));
+	}
+
+	SoA soa;
+
+	soa.assign(packed);
+
+	EXPECT_EQ(soa.size(), count);
+
+	for (size_t i = 0; i < count; i++) {
+		EXPECT_EQ(soa[i].get<SoA::Element::LEN>(), i);
+		soa[i].set<SoA::Element::STATUS>(7);
+	}
+
+	std::vector<SoA::Packed> out(count);
+
+	soa.copyTo(out);
+
+	for (size_t i = 0; i < count; i++) {
+		EXPECT_EQ(out[i].get<SoA::Packed::LEN>(), i);
+		EXPECT_EQ(out[i].get<SoA::Packed::STATUS>(), 7);
+		EXPECT_EQ(out[i].get<SoA::Packed::ADDR>(), i * 3);
+	}
+}
@@ -0,0 +1,145 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Dmitrii Lebed <lebed.dmitry@gmail.com>
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstring>
+
+#include <bitfieldset_view.hpp>
+
+using namespace hal;
+
+struct TestViewHeaderDef {
+	enum FIELDS {
+		LEN,
+		TYPE,
+		FLAGS,
+		SEQ,
+
+		/* keep last */
+		FIELD_COUNT
+	};
+
+	using WordType = uint32_t;
+
+	static constexpr size_t fieldCount = FIELD_COUNT;
+	static constexpr size_t wordCount = 2;
+
+	__extension__
+	static constexpr struct BitField<WordType> layout[fieldCount] =
+	{
+		[LEN]	= { .word = 0,	.lsb = 0,	.msb = 15	},
+		[TYPE]	= { .word = 0,	.lsb = 16,	.msb = 23	},
+		[FLAGS]	= { .word = 0,	.lsb = 24,	.msb = 31	},
+		[SEQ]	= { .word = 1,	.lsb = 0,	.msb = 31	},
+	};
+};
+
+TEST(BitFieldSetViewTest, UnalignedBuffer)
+{
+	using View = BitFieldSetView<TestViewHeaderDef>;
+
+	static_assert(View::Storage::size == 8);
+
+	alignas(4) std::array<std::byte, 16> buf = {};
+	const uint32_t words[] = { 0xa5123456, 0xdeadbeef };
+
+	/* header at odd offset inside the packet */
+	std::memcpy(buf.data() + 1, words, sizeof(words));
+
+	View v(std::span<std::byte>(buf).subspan(1));
+
+	EXPECT_EQ(v.get<View::LEN>(), 0x3456);
+	EXPECT_EQ(v.get<View::TYPE>(), 0x12);
+	EXPECT_EQ(v.get<View::SEQ>(), 0xdeadbeef);
+
+	const auto w = v.word<View::LEN>();
+
+	EXPECT_EQ(w.get<View::FLAGS>(), 0xa5);
+
+	/* fields are written in place, surrounding bytes are not touched */
+	v.set<View::TYPE, View::SEQ>(0x77, 0x1);
+	v.modify<View::LEN>().set<View::LEN>(0x40);
+
+	uint32_t out[2];
+
+	std::memcpy(out, buf.data() + 1, sizeof(out));
+
+	EXPECT_EQ(out[0], 0xa5770040);
+	EXPECT_EQ(out[1], 0x1);
+	EXPECT_EQ(buf[0], std::byte(0));
+	EXPECT_EQ(buf[9], std::byte(0));
+}
+
+TEST(BitFieldSetViewTest, AlignedBuffer)
+{
+	using View = BitFieldSetView<TestViewHeaderDef, BitFieldViewAligned>;
+
+	uint32_t words[] = { 0, 0 };
+	View v(words);
+
+	v.set<View::LEN, View::FLAGS>(0x1234, 0x80);
+	v.set<View::SEQ>(42);
+
+	EXPECT_EQ(words[0], 0x80001234);
+	EXPECT_EQ(words[1], 42);
+	EXPECT_EQ(v.get<View::FLAGS>(), 0x80);
+	EXPECT_EQ(v.storage().data(), reinterpret_cast<std::byte *>(words));
+}
+
+template <typename TStorage>
+constexpr bool hasStore = requires(TStorage &st) { st.template store<0>(0u); };
+
+TEST(BitFieldSetViewTest, ConstBuffer)
+{
+	using View = BitFieldSetConstView<TestViewHeaderDef>;
+
+	static_assert(!hasStore<View::Storage>);
+
+	std::array<std::byte, 9> rx = {};
+	const uint32_t words[] = { 0x01020304, 0x11223344 };
+
+	std::memcpy(rx.data() + 1, words, sizeof(words));
+
+	/* received packet parsed in place */
+	const auto &packet = rx;
+	View v(std::span<const std::byte>(packet).subspan(1));
+
+	EXPECT_EQ(v.get<View::LEN>(), 0x0304);
+	EXPECT_EQ(v.get<View::FLAGS>(), 0x01);
+	EXPECT_EQ(v.get(View::TYPE), 0x02);
+	EXPECT_TRUE(v.equals<View::SEQ>(0x11223344));
+
+	const auto fields = v.unpack<View::LEN, View::TYPE>();
+
+	EXPECT_EQ(fields[0], 0x0304);
+	EXPECT_EQ(fields[1], 0x02);
+	EXPECT_EQ(v.storage().data(), packet.data() + 1);
+}
+
+#ifndef NDEBUG
+TEST(BitFieldSetViewTest, BufferTooSmall)
+{
+	std::array<std::byte, 2> buf = {};
+
+	EXPECT_DEATH(BitFieldSetView<TestViewHeaderDef>{std::span<std::byte>(buf)}, "buffer is too small");
+	EXPECT_DEATH(BitFieldSetConstView<TestViewHeaderDef>{std::span<const std::byte>(buf)}, "buffer is too small");
+}
+
+TEST(BitFieldSetViewTest, MisalignedBuffer)
+{
+	alignas(uint32_t) std::array<std::byte, 16> buf = {};
+	const std::span<std::byte> misaligned(buf.data() + 1, 8);
+
+	EXPECT_DEATH((BitFieldSetView<TestViewHeaderDef, BitFieldViewAligned>{misaligned}), "buffer is misaligned");
+	EXPECT_DEATH((BitFieldSetConstView<TestViewHeaderDef, BitFieldViewAligned>{buf.data() + 2}), "buffer is misaligned");
+
+	/* no alignment requirements for unaligned access policy */
+	BitFieldSetView<TestViewHeaderDef, BitFieldViewUnaligned> v{misaligned};
+
+	EXPECT_EQ(v.storage().data(), buf.data() + 1);
+}
+#endif
@@ -0,0 +1,110 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Dmitrii Lebed <lebed.dmitry@gmail.com>
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+/* CSR accessors on host CSR emulation backend (CONFIG_RV_CSR_HOST) */
+
+#include <gtest/gtest.h>
+
+#include <arch/riscv/rv_csr.hpp>
+
+using namespace rv;
+
+class RvCsrTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		host::hart_csrs.reset();
+	}
+};
+
+TEST_F(RvCsrTest, Xlen)
+{
+	static_assert(sizeof(uxlen_t) * 8 == CONFIG_RV_HOST_XLEN);
+	static_assert(sizeof(xlen_t) == sizeof(uxlen_t));
+}
+
+TEST_F(RvCsrTest, ReadWrite)
+{
+	csr_write<csr::mscratch>(0x1234);
+	csr_write<csr::mepc>(0x80000000);
+
+	EXPECT_EQ(csr_read<csr::mscratch>(), 0x1234);
+	EXPECT_EQ(csr_read<csr::mepc>(), 0x80000000);
+	EXPECT_EQ(csr_read<csr::sscratch>(), 0);
+
+	EXPECT_EQ(host::hart_csrs.read_count(csr::mscratch), 1);
+	EXPECT_EQ(host::hart_csrs.write_count(csr::mscratch), 1);
+	EXPECT_EQ(host::hart_csrs.write_count(csr::sscratch), 0);
+
+	host::hart_csrs.reset_counters();
+
+	EXPECT_EQ(host::hart_csrs.peek(csr::mepc), 0x80000000);
+	EXPECT_EQ(host::hart_csrs.read_count(csr::mepc), 0);
+}
+
+TEST_F(RvCsrTest, Hooks)
+{
+	host::hart_csrs.set_hooks(csr::mcycle, host::csr_read_tick);
+	host::hart_csrs.set_hooks(csr::mip, host::csr_read_to_clear);
+	host::hart_csrs.set_hooks(csr::mhartid, nullptr, host::csr_write_ignore);
+	host::hart_csrs.poke(csr::mcycle, 100);
+	host::hart_csrs.poke(csr::mhartid, 3);
+
+	EXPECT_EQ(csr_read<csr::mcycle>(), 100);
+	EXPECT_EQ(csr_read<csr::mcycle>(), 101);
+
+	csr_write<csr::mip>(0x80);
+
+	EXPECT_EQ(csr_read<csr::mip>(), 0x80);
+	EXPECT_EQ(csr_read<csr::mip>(), 0);
+
+	csr_write<csr::mhartid>(7);
+
+	EXPECT_EQ(csr_read<csr::mhartid>(), 3);
+	EXPECT_EQ(host::hart_csrs.write_count(csr::mhartid), 1);
+}
+
+TEST_F(RvCsrTest, Indexed)
+{
+	for (size_t i = 0; i < 16; i++) {
+		csr_write_pmpaddr(i, static_cast<uxlen_t>(i * 0x100));
+	}
+
+	/* out of range index is ignored */
+	csr_write_pmpaddr(16, 0x5);
+
+	EXPECT_EQ(csr_read<csr::pmpaddr0>(), 0);
+	EXPECT_EQ(csr_read<csr::pmpaddr7>(), 0x700);
+	EXPECT_EQ(csr_read_pmpaddr(15), 0xf00);
+	EXPECT_EQ(csr_read_pmpaddr(16), 0);
+	EXPECT_EQ(host::hart_csrs.peek(static_cast<csr>(static_cast<uint16_t>(csr::pmpaddr15) + 1)), 0);
+}
+
+TEST_F(RvCsrTest, Range)
+{
+	std::array<uxlen_t, 16> pmpaddr;
+	std::array<uxlen_t, 29> counters = {};
+
+	for (size_t i = 0; i < pmpaddr.size(); i++) {
+		pmpaddr[i] = static_cast<uxlen_t>(0x1000 + i);
+	}
+
+	EXPECT_EQ((csr_write_range<csr::pmpaddr0, csr::pmpaddr15>(pmpaddr)), 16);
+	EXPECT_EQ(csr_read_pmpaddr(0), 0x1000);
+	EXPECT_EQ(csr_read_pmpaddr(15), 0x100f);
+	EXPECT_EQ(host::hart_csrs.write_count(csr::pmpaddr7), 1);
+
+	/* too small buffer: no CSR access */
+	EXPECT_EQ((csr_write_range<csr::pmpaddr0, csr::pmpaddr15>(std::span(pmpaddr).first(15))), 0);
+	EXPECT_EQ(host::hart_csrs.write_count(csr::pmpaddr0), 1);
+
+	host::hart_csrs.poke(csr::mhpmcounter3, 3);
+	host::hart_csrs.poke(csr::mhpmcounter31, 31);
+
+	EXPECT_EQ((csr_read_range<csr::mhpmcounter3, csr::mhpmcounter31>(counters)), 29);
+	EXPECT_EQ(counters[0], 3);
+	EXPECT_EQ(counters[28], 31);
+	EXPECT_EQ(host::hart_csrs.read_count(csr::mhpmcounter17), 1);
+}
@@ -0,0 +1,136 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Dmitrii Lebed <lebed.dmitry@gmail.com>
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+/* CSR context save/restore on host CSR emulation backend (CONFIG_RV_CSR_HOST) */
+
+#include <gtest/gtest.h>
+
+#include <arch/riscv/rv_csr_context.hpp>
+
+using namespace rv;
+
+class RvCsrContextTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		host::hart_csrs.reset();
+	}
+};
+
+TEST_F(RvCsrContextTest, SnapshotRestore)
+{
+	host::hart_csrs.poke(csr::mepc, 0x80001000);
+	host::hart_csrs.poke(csr::mscratch, 0x55);
+	host::hart_csrs.poke(csr::mtval, 0xdead);
+
+	const auto saved = csr_snapshot<csr::mepc, csr::mscratch, csr::mtval>();
+
+	EXPECT_EQ(saved.size(), 3);
+	EXPECT_EQ(saved[0], 0x80001000);
+	EXPECT_EQ(saved[1], 0x55);
+	EXPECT_EQ(saved[2], 0xdead);
+
+	host::hart_csrs.reset();
+	csr_restore<csr::mepc, csr::mscratch, csr::mtval>(saved);
+
+	EXPECT_EQ(host::hart_csrs.peek(csr::mepc), 0x80001000);
+	EXPECT_EQ(host::hart_csrs.peek(csr::mscratch), 0x55);
+	EXPECT_EQ(host::hart_csrs.peek(csr::mtval), 0xdead);
+	EXPECT_EQ(host::hart_csrs.read_count(csr::mepc), 0);
+	EXPECT_EQ(host::hart_csrs.write_count(csr::mepc), 1);
+}
+
+TEST_F(RvCsrContextTest, Groups)
+{
+	static_assert(trap_frame_csrs::count == 4);
+	static_assert(trap_frame_csrs::index<csr::mcause>() == 2);
+	static_assert(smode_csrs::list[smode_csrs::count - 1] == csr::satp);
+	static_assert(hmode_csrs::list[hmode_csrs::count - 1] == csr::vsatp);
+	static_assert(csr::vsstatus == csr::bsstatus);
+
+	for (size_t i = 0; i < hmode_csrs::count; i++) {
+		host::hart_csrs.poke(hmode_csrs::list[i], static_cast<uxlen_t>(i + 1));
+	}
+
+	hmode_csrs::values guest = hmode_csrs::snapshot();
+
+	EXPECT_EQ(guest[hmode_csrs::index<csr::hstatus>()], 1);
+	EXPECT_EQ(guest[hmode_csrs::index<csr::vsatp>()], hmode_csrs::count);
+
+	guest[hmode_csrs::index<csr::vsepc>()] = 0x1000;
+	hmode_csrs::restore(guest);
+
+	EXPECT_EQ(host::hart_csrs.peek(csr::vsepc), 0x1000);
+	EXPECT_EQ(host::hart_csrs.peek(csr::hgatp), hmode_csrs::count - 1);
+
+	for (csr reg : hmode_csrs::list) {
+		EXPECT_EQ(host::hart_csrs.read_count(reg), 1);
+		EXPECT_EQ(host::hart_csrs.write_count(reg), 1);
+	}
+}
+
+static uint64_t total_writes()
+{
+	uint64_t n = 0;
+
+	for (csr reg : hmode_csrs::list) {
+		n += host::hart_csrs.write_count(reg);
+	}
+
+	return n;
+}
+
+TEST_F(RvCsrContextTest, LazyContext)
+{
+	vcpu_csr_context vcpu0;
+	vcpu_csr_context vcpu1;
+
+	host::hart_csrs.poke(csr::hgatp, 0x8000);
+	host::hart_csrs.poke(csr::vsepc, 0x1000);
+
+	vcpu0.save();
+	EXPECT_FALSE(vcpu0.is_dirty());
+	EXPECT_EQ(vcpu0.get<csr::hgatp>(), 0x8000);
+
+	/* nothing changed: no CSR traffic */
+	vcpu0.restore();
+	EXPECT_EQ(total_writes(), 0);
+
+	/* setting the same value does not dirty the CSR */
+	vcpu0.set<csr::hgatp>(0x8000);
+	vcpu0.set<csr::hvip>(0x400);
+	EXPECT_FALSE(vcpu0.is_dirty<csr::hgatp>());
+	EXPECT_TRUE(vcpu0.is_dirty<csr::hvip>());
+
+	vcpu0.restore();
+	EXPECT_EQ(host::hart_csrs.peek(csr::hvip), 0x400);
+	EXPECT_EQ(total_writes(), 1);
+
+	/* identical context: switch is a no-op */
+	vcpu1 = vcpu0;
+	host::hart_csrs.reset_counters();
+	vcpu1.switch_from(vcpu0);
+	EXPECT_EQ(total_writes(), 0);
+
+	/* only CSRs differing from the resident context are written */
+	vcpu1.set<csr::hgatp>(0x9000);
+	vcpu1.set<csr::vsepc>(0x2000);
+	vcpu1.switch_from(vcpu0);
+	EXPECT_EQ(host::hart_csrs.peek(csr::hgatp), 0x9000);
+	EXPECT_EQ(host::hart_csrs.peek(csr::vsepc), 0x2000);
+	EXPECT_EQ(total_writes(), 2);
+
+	/* switch back: values differ from vcpu1, vcpu0 is clean */
+	host::hart_csrs.reset_counters();
+	vcpu1.save();
+	vcpu0.switch_from(vcpu1);
+	EXPECT_EQ(host::hart_csrs.peek(csr::hgatp), 0x8000);
+	EXPECT_EQ(host::hart_csrs.peek(csr::vsepc), 0x1000);
+	EXPECT_EQ(total_writes(), 2);
+
+	vcpu0.mark_dirty();
+	vcpu0.restore();
+	EXPECT_EQ(total_writes(), 2 + hmode_csrs::count);
+}
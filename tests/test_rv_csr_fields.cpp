@@ -0,0 +1,197 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Dmitrii Lebed <lebed.dmitry@gmail.com>
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+/* BitFieldSet-typed CSRs on host CSR emulation backend (CONFIG_RV_CSR_HOST) */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <arch/riscv/rv_csr_fields.hpp>
+
+using namespace rv;
+
+/* whole CSR as a single field */
+struct RawCsrDef {
+	enum FIELDS {
+		VALUE,
+
+		/* keep last */
+		FIELD_COUNT
+	};
+
+	using WordType = uxlen_t;
+
+	static constexpr size_t fieldCount = FIELD_COUNT;
+	static constexpr size_t wordCount = 1;
+
+	__extension__
+	static constexpr struct hal::BitField<WordType> layout[fieldCount] =
+	{
+		[VALUE]	= { .word = 0,	.lsb = 0	},
+	};
+};
+
+/* single field not covering the whole CSR, upper bits are reserved */
+struct LowByteCsrDef {
+	enum FIELDS {
+		LO,
+
+		/* keep last */
+		FIELD_COUNT
+	};
+
+	using WordType = uxlen_t;
+
+	static constexpr size_t fieldCount = FIELD_COUNT;
+	static constexpr size_t wordCount = 1;
+
+	__extension__
+	static constexpr struct hal::BitField<WordType> layout[fieldCount] =
+	{
+		[LO]	= { .word = 0,	.lsb = 0,	.msb = 7	},
+	};
+};
+
+class RvCsrFieldsTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		host::hart_csrs.reset();
+	}
+};
+
+TEST_F(RvCsrFieldsTest, SetClear)
+{
+	Mstatus mstatus;
+
+	host::hart_csrs.poke(csr::mstatus, 0x1800);
+
+	/* single bit: csrs/csrc, MPP is left intact */
+	mstatus.set<MstatusDef::MIE>(1);
+	EXPECT_EQ(host::hart_csrs.peek(csr::mstatus), 0x1808);
+	mstatus.set<MstatusDef::MIE>(0);
+	EXPECT_EQ(host::hart_csrs.peek(csr::mstatus), 0x1800);
+
+	/* multi-bit: csrs + csrc */
+	mstatus.set<MstatusDef::MPP>(1);
+	EXPECT_EQ(host::hart_csrs.peek(csr::mstatus), 0x0800);
+	EXPECT_EQ(mstatus.get<MstatusDef::MPP>(), 1);
+
+	mstatus.set<MstatusDef::MPIE, MstatusDef::FS>(1, 3);
+	EXPECT_EQ(host::hart_csrs.peek(csr::mstatus), 0x6880);
+
+	/* mip.MTIP is read-only */
+	Mip mip;
+
+	mip.set<MipDef::SSIP>(1);
+	EXPECT_EQ(host::hart_csrs.peek(csr::mip), 0x2);
+}
+
+TEST_F(RvCsrFieldsTest, WholeWordWrite)
+{
+	Mcause mcause;
+	Mtvec mtvec;
+
+	host::hart_csrs.poke(csr::mcause, 0x5);
+
+	/* all defined bits covered: plain csrw, no read */
+	mcause.set<CauseDef::INTERRUPT, CauseDef::CODE>(1, 7);
+	EXPECT_EQ(host::hart_csrs.peek(csr::mcause), (uxlen_t{1} << (RV_XLEN - 1)) | 7);
+	EXPECT_EQ(host::hart_csrs.read_count(csr::mcause), 0);
+	EXPECT_EQ(host::hart_csrs.write_count(csr::mcause), 1);
+
+	EXPECT_EQ(mcause.get<CauseDef::INTERRUPT>(), 1);
+	EXPECT_EQ(mcause.get<CauseDef::CODE>(), 7);
+
+	mtvec.set<TvecDef::BASE, TvecDef::MODE>(0x80000100 >> 2, TvecDef::MODE_VECTORED);
+	EXPECT_EQ(host::hart_csrs.peek(csr::mtvec), 0x80000101);
+	EXPECT_EQ(host::hart_csrs.read_count(csr::mtvec), 0);
+}
+
+TEST_F(RvCsrFieldsTest, Exchange)
+{
+	Mstatus mstatus;
+	Mie mie;
+	Scause scause;
+
+	host::hart_csrs.poke(csr::mstatus, 0x1808);
+
+	/* interrupt disable returning previous state: csrrci */
+	EXPECT_EQ(mstatus.exchange<MstatusDef::MIE>(0), 1);
+	EXPECT_EQ(host::hart_csrs.peek(csr::mstatus), 0x1800);
+	EXPECT_EQ(mstatus.exchange<MstatusDef::MIE>(1), 0);
+	EXPECT_EQ(host::hart_csrs.peek(csr::mstatus), 0x1808);
+
+	/* multi-bit field: csrrs + csrc */
+	EXPECT_EQ(mstatus.exchange<MstatusDef::MPP>(1), 3);
+	EXPECT_EQ(host::hart_csrs.peek(csr::mstatus), 0x0808);
+
+	/* bit above immediate range */
+	EXPECT_EQ(mie.exchange<MieDef::MEIE>(1), 0);
+	EXPECT_EQ(host::hart_csrs.peek(csr::mie), 0x800);
+
+	/* field covering the whole CSR: csrrw */
+	CsrBitFieldSet<csr::scause, RawCsrDef> scauseRaw;
+
+	scause.set<CauseDef::CODE>(13);
+	host::hart_csrs.reset_counters();
+
+	EXPECT_EQ(scauseRaw.exchange<RawCsrDef::VALUE>(15), 13);
+	EXPECT_EQ(host::hart_csrs.peek(csr::scause), 15);
+	EXPECT_EQ(host::hart_csrs.read_count(csr::scause), 1);
+	EXPECT_EQ(host::hart_csrs.write_count(csr::scause), 1);
+}
+
+TEST_F(RvCsrFieldsTest, ExchangePartialWord)
+{
+	CsrBitFieldSet<csr::mscratch, LowByteCsrDef> scratch;
+
+	/* csrrw of the only field, value is masked like set() does */
+	scratch.set<LowByteCsrDef::LO>(0x1ff);
+	EXPECT_EQ(host::hart_csrs.peek(csr::mscratch), 0xff);
+
+	EXPECT_EQ(scratch.exchange<LowByteCsrDef::LO>(0xabcd12), 0xff);
+	EXPECT_EQ(host::hart_csrs.peek(csr::mscratch), 0x12);
+}
+
+/* every value written to mstatus, recorded by the write hook */
+static std::vector<uxlen_t> mstatus_writes;
+
+static void record_write(csr, uxlen_t &stored, uxlen_t value)
+{
+	mstatus_writes.push_back(value);
+	stored = value;
+}
+
+TEST_F(RvCsrFieldsTest, MultiBitIntermediate)
+{
+	constexpr uxlen_t fs_mask = 0x6000;
+	Mstatus mstatus;
+
+	mstatus_writes.clear();
+	host::hart_csrs.set_hooks(csr::mstatus, nullptr, record_write);
+
+	/* FS: Initial -> Clean -> Dirty -> Initial, trap at any point must not see Off */
+	host::hart_csrs.poke(csr::mstatus, 0x2008);
+
+	mstatus.set<MstatusDef::FS>(2);
+	EXPECT_EQ(mstatus.get<MstatusDef::FS>(), 2);
+	mstatus.set<MstatusDef::FS>(3);
+	EXPECT_EQ(mstatus.exchange<MstatusDef::FS>(1), 3);
+	EXPECT_EQ(mstatus.get<MstatusDef::FS>(), 1);
+
+	ASSERT_FALSE(mstatus_writes.empty());
+
+	for (uxlen_t v : mstatus_writes) {
+		EXPECT_NE(v & fs_mask, 0) << std::hex << v;
+		/* other fields are not touched */
+		EXPECT_EQ(v & ~fs_mask, 0x8) << std::hex << v;
+	}
+
+	/* intermediate value of Initial -> Clean is the union Dirty */
+	EXPECT_EQ(mstatus_writes[0], 0x6008);
+	EXPECT_EQ(mstatus_writes[1], 0x4008);
+}
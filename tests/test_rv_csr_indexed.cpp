@@ -0,0 +1,42 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Dmitrii Lebed <lebed.dmitry@gmail.com>
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+/*
+ * Indexed CSR accessors over user mode accessible floating-point CSRs
+ *
+ * Built on host CSR emulation backend (function table dispatch) and, on RISC-V targets
+ * with F extension, natively with CONFIG_RV_CSR_INDEXED_ASM (jump table dispatch)
+ */
+
+#include <gtest/gtest.h>
+
+#include <arch/riscv/rv_csr.hpp>
+
+using namespace rv;
+
+TEST(RvCsrIndexed, Write)
+{
+	/* fflags (index 0) and frm (index 1) */
+	helpers::csr_write_indexed<csr::fflags, csr::frm>(0, 0x1f);
+	helpers::csr_write_indexed<csr::fflags, csr::frm>(1, 0x2);
+
+	EXPECT_EQ(csr_read<csr::fflags>(), 0x1f);
+	EXPECT_EQ(csr_read<csr::frm>(), 0x2);
+
+	helpers::csr_write_indexed<csr::fflags, csr::frm>(0, 0x5);
+	helpers::csr_write_indexed<csr::fflags, csr::frm>(1, 0x1);
+
+	EXPECT_EQ(csr_read<csr::fflags>(), 0x5);
+	EXPECT_EQ(csr_read<csr::frm>(), 0x1);
+}
+
+TEST(RvCsrIndexed, Read)
+{
+	csr_write<csr::fflags>(0x3);
+	csr_write<csr::frm>(0x4);
+
+	EXPECT_EQ((helpers::csr_read_indexed<csr::fflags, csr::frm>(0)), 0x3);
+	EXPECT_EQ((helpers::csr_read_indexed<csr::fflags, csr::frm>(1)), 0x4);
+}